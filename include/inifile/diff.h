@@ -0,0 +1,98 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "inifile/inifile.h"
+
+namespace ini
+{
+
+/**
+ * A change of one key, inside a SectionChange.
+ */
+struct KeyChange
+{
+    enum class Kind
+    {
+        /// A new key with value.
+        Add,
+        /// An existing key gets a new value.
+        Change,
+        /// A key is removed.
+        Remove,
+    };
+
+    Kind kind;
+    std::string key;
+    /// The new value for Add and Change, otherwise empty.
+    std::string value;
+};
+
+/**
+ * All changes of one section between two Files.
+ * The section name is stored once for all its keys.
+ */
+struct SectionChange
+{
+    enum class Kind
+    {
+        /// A new section. Its keys follow as KeyChange::Kind::Add.
+        Add,
+        /// A section is removed with all its keys. No key follows.
+        Remove,
+        /// Keys of a section in both Files change.
+        Modify,
+    };
+
+    Kind kind;
+    std::string section;
+    /// Sorted by key.
+    std::vector<KeyChange> keys;
+};
+
+/// Changes sorted by section.
+using Patch = std::vector<SectionChange>;
+
+/// Get the changes which turn `from` into `to`.
+/// It takes a single walk over both Files, as they are sorted.
+[[nodiscard]]
+Patch diff(File const& from, File const& to);
+
+/// Apply the changes to file.
+/// Changes whose target is already in the wanted state are ignored.
+void apply(File& file, Patch const& patch);
+
+/// Serialize patch to ship it, in a compact binary form with length-prefixed strings.
+[[nodiscard]]
+std::string encode_patch(Patch const& patch);
+
+/// Read a patch made by encode_patch().
+/// Return nothing if data is truncated or malformed.
+[[nodiscard]]
+std::optional<Patch> decode_patch(std::string_view data);
+
+/**
+ * A key, or a whole section when `key` is empty,
+ * which has been changed differently on both sides of a merge.
+ */
+struct Conflict
+{
+    std::string section;
+    std::string key;
+};
+
+struct MergeResult
+{
+    /// Merged content. Conflicts are resolved in favor of `ours`.
+    File file;
+    std::vector<Conflict> conflicts;
+};
+
+/// Three-way merge of the changes from `base` to `ours` and from `base` to `theirs`.
+[[nodiscard]]
+MergeResult merge(File const& base, File const& ours, File const& theirs);
+
+} // namespace ini
@@ -1,17 +1,27 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <charconv>
+#include <coroutine>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <istream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <ranges>
 #include <ostream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <type_traits>
+#include <vector>
 
 #include "fmt/format.h"
+#include "inifile/stats.h"
 
 namespace ini
 {
@@ -67,6 +77,47 @@ struct Decoder<bool>
     }
 };
 
+/// Scratch space for Encoder, large enough for any number.
+using EncodeBuffer = std::array<char, 128>;
+
+template<typename T, typename Enable = void>
+struct Encoder
+{
+    Encoder() = delete;
+};
+
+template<typename T>
+struct Encoder<T, std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>>>
+{
+    static std::string_view encode(T const& value, EncodeBuffer& buffer)
+    {
+        auto [ptr, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+        return std::string_view(buffer.data(), static_cast<std::size_t>(ptr - buffer.data()));
+    }
+};
+
+template<>
+struct Encoder<bool>
+{
+    static std::string_view encode(bool const& value, EncodeBuffer& /*buffer*/)
+    {
+        return value ? "true" : "false";
+    }
+};
+
+template<typename T>
+struct Encoder<T, std::enable_if_t<std::is_convertible_v<T const&, std::string_view>>>
+{
+    static std::string_view encode(T const& value, EncodeBuffer& /*buffer*/)
+    {
+        return value;
+    }
+};
+
+/// A fast 64-bit hash with the xxHash64 algorithm.
+[[nodiscard]]
+std::uint64_t hash64(std::string_view data, std::uint64_t seed = 0);
+
 /**
  * An interface to ini file.
  * It can convert to any c++ type easily if a converter is defined.
@@ -76,10 +127,30 @@ class Field
   public:
     Field() = default;
 
+    Field(Field const& other): value_(other.value_), hash_(other.hash_.load(std::memory_order_relaxed)) {}
+    Field& operator=(Field const& other)
+    {
+        value_ = other.value_;
+        hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /// The moved-from Field drops its cache, as its value is gone.
+    Field(Field&& other) noexcept
+        : value_(std::move(other.value_)), hash_(other.hash_.exchange(0, std::memory_order_relaxed))
+    {}
+    Field& operator=(Field&& other) noexcept
+    {
+        value_ = std::move(other.value_);
+        hash_.store(other.hash_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
     explicit Field(std::string value): value_(std::move(value)) {}
     Field& operator=(std::string value)
     {
         value_ = std::move(value);
+        hash_.store(0, std::memory_order_relaxed);
         return *this;
     }
 
@@ -87,6 +158,7 @@ class Field
     Field& operator=(std::string_view value)
     {
         value_ = value;
+        hash_.store(0, std::memory_order_relaxed);
         return *this;
     }
 
@@ -94,6 +166,7 @@ class Field
     Field& operator=(char const* value)
     {
         value_ = value;
+        hash_.store(0, std::memory_order_relaxed);
         return *this;
     }
 
@@ -107,27 +180,218 @@ class Field
     [[nodiscard]]
     char const* as_cstr() const { return value_.c_str(); }
 
+    /// Get the hash of the inner string.
+    /// It is computed on first call and cached until the next assignment.
+    /// Concurrent calls on a const Field are safe, and at worst compute the hash twice.
+    [[nodiscard]]
+    std::uint64_t fingerprint() const
+    {
+        auto hash = hash_.load(std::memory_order_relaxed);
+        if (hash == 0)
+        {
+            // 0 marks an empty cache.
+            hash = hash64(value_) | 1;
+            hash_.store(hash, std::memory_order_relaxed);
+        }
+        return hash;
+    }
+
     /// Convert into type `T`.
     template <typename T>
     [[nodiscard]]
-    T to()
+    T to() const
     {
+#ifdef INI_ENABLE_STATS
+        try
+        {
+            return Decoder<T>::decode(value_);
+        }
+        catch (DecodeError const&)
+        {
+            stats::record_conversion_failure(typeid(T));
+            throw;
+        }
+#else
         return Decoder<T>::decode(value_);
+#endif
     }
 
   private:
     std::string value_;
+    mutable std::atomic<std::uint64_t> hash_ = 0;
 };
 
 /**
  * Process ini section.
  */
-class Section: public std::map<std::string, Field> {};
+class Section: public std::map<std::string, Field, std::less<>>
+{
+  public:
+    /// Get all keys starting with prefix, in O(log n).
+    [[nodiscard]]
+    std::ranges::subrange<iterator> keys_with_prefix(std::string_view prefix);
+    [[nodiscard]]
+    std::ranges::subrange<const_iterator> keys_with_prefix(std::string_view prefix) const;
+
+    /// Get all keys matching a glob pattern like "pool.*".
+    /// Only the keys starting with the part before the first wildcard are checked.
+    [[nodiscard]]
+    std::vector<const_iterator> keys_matching(std::string_view pattern) const;
+
+    /// Get a hash of all keys and values.
+    /// Values reuse the cache of Field::fingerprint(),
+    /// so only the keys are hashed again after a change.
+    [[nodiscard]]
+    std::uint64_t fingerprint() const;
+};
+
+/**
+ * A problem found by File::decode() in diagnostics mode.
+ */
+struct Diagnostic
+{
+    enum class Kind
+    {
+        /// A key-value pair appears before any section.
+        MissingSection,
+        /// A line is neither a section, a key-value pair nor a comment.
+        InvalidLine,
+        /// A limit in Limits is exceeded. Decoding stops here.
+        LimitExceeded,
+    };
+
+    Kind kind;
+    /// Line number, starting from 1.
+    int line;
+    /// Column number in bytes, starting from 1.
+    int column;
+    /// Byte offset from the beginning of the input.
+    std::size_t offset;
+
+    /// Get a human readable description of kind.
+    [[nodiscard]]
+    std::string_view message() const;
+};
+
+/**
+ * Resource limits for File::decode(), to process untrusted input safely.
+ *
+ * Decoding stops as soon as a limit is exceeded.
+ * Streams are read in chunks of at most 64 KiB, and never more than one byte
+ * past max_line_length or max_total_bytes, so memory stays within
+ * O(min(max_line_length, max_total_bytes)) beyond the decoded File.
+ * Every byte is scanned a constant number of times,
+ * so decoding n bytes into k keys takes O(n + k log k) time.
+ */
+struct Limits
+{
+    static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+
+    /// Bytes in a line, without the line break.
+    std::size_t max_line_length = UNLIMITED;
+    /// Bytes in a key.
+    std::size_t max_key_size = UNLIMITED;
+    /// Bytes in a value.
+    std::size_t max_value_size = UNLIMITED;
+    /// Sections created by one decoding.
+    std::size_t max_sections = UNLIMITED;
+    /// Keys created by one decoding.
+    std::size_t max_keys = UNLIMITED;
+    /// Bytes of the whole input.
+    std::size_t max_total_bytes = UNLIMITED;
+};
+
+/**
+ * Options for File::write().
+ */
+struct WriteOptions
+{
+    /// Write into a temporary file and rename it over the target,
+    /// so that a crash never leaves a truncated file behind.
+    /// The new file keeps the mode of the old one, and its owner when permitted.
+    /// A symlink is followed, and the file it points to is replaced.
+    bool atomic = false;
+
+    /// Flush the file (and the directory when `atomic`) to disk before return.
+    /// Only POSIX systems support it; elsewhere it has no effect.
+    bool sync = false;
+
+    /// Encode sections on up to this many threads, 0 for one per hardware thread.
+    /// Only large documents are split; the output is the same as File::encode().
+    unsigned threads = 1;
+};
+
+/**
+ * Resume a coroutine on the thread of the caller's choice,
+ * usually by posting the handle to an event loop.
+ */
+using Executor = std::function<void(std::coroutine_handle<>)>;
+
+/**
+ * Result of a File operation running on a worker thread.
+ *
+ * Operations run on a shared pool of max(2, hardware threads) workers.
+ * A coroutine can `co_await` the result without blocking its own thread:
+ * it is suspended, and handed to the Executor once the operation is done.
+ * Without an Executor it is resumed on the worker itself, and then must not block on
+ * another AsyncResult, which could wait for a worker that is never free.
+ * Other code can block on get() instead, like on a std::future.
+ *
+ * File::read() parses each 64 KiB chunk as soon as it is read, while the kernel's
+ * sequential read-ahead fetches the next one, so reading and parsing overlap.
+ * io_uring is not used: parsing and encoding need a thread anyway,
+ * and it would add a Linux-only liburing dependency for little gain on config-sized files.
+ */
+class AsyncResult
+{
+  public:
+    /// Start operation on the worker pool.
+    /// Resume an awaiting coroutine with executor, if it is set.
+    explicit AsyncResult(std::function<bool()> operation, Executor executor = {});
+
+    AsyncResult(AsyncResult&&) noexcept = default;
+    AsyncResult& operator=(AsyncResult&&) = delete;
+
+    /// Wait for the operation, as the File it works on may be gone afterwards.
+    ~AsyncResult();
+
+    /// Block until the operation is done and get its result.
+    /// Rethrow the exception thrown by the operation, if any.
+    bool get();
+
+    [[nodiscard]]
+    bool await_ready() const;
+    bool await_suspend(std::coroutine_handle<> handle);
+    bool await_resume();
+
+  private:
+    struct State;
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * Heap used by a File, as reported by File::memory_usage().
+ * Node sizes are estimated from the usual red-black tree layout.
+ */
+struct MemoryUsage
+{
+    /// Bytes of map nodes holding sections and keys.
+    std::size_t nodes = 0;
+    /// Bytes of heap strings in use, including the terminating null.
+    /// Short strings stored inline take no extra bytes.
+    std::size_t strings = 0;
+    /// Bytes of heap strings allocated but not in use.
+    std::size_t slack = 0;
+
+    /// Get the sum of all parts.
+    [[nodiscard]]
+    std::size_t total() const { return nodes + strings + slack; }
+};
 
 /**
  * Core process class.
  */
-class File: public std::map<std::string, Section>
+class File: public std::map<std::string, Section, std::less<>>
 {
   public:
     /// Read file from path and decode it.
@@ -140,6 +404,25 @@ class File: public std::map<std::string, Section>
     /// Run File::error() for mare information.
     bool write(std::filesystem::path const& file) const;
 
+    /// Write to a file with extra options.
+    /// Return false iff error happen.
+    /// Run File::error() for mare information.
+    bool write(std::filesystem::path const& file, WriteOptions const& options) const;
+
+    /// Run File::read() on a worker thread, as in `co_await file.async_read(path)`.
+    /// An awaiting coroutine is resumed through executor, if it is set.
+    /// The File must not be accessed until the result is ready.
+    [[nodiscard]]
+    AsyncResult async_read(std::filesystem::path file, Executor executor = {});
+
+    /// Run File::write() on a worker thread, as in `co_await file.async_write(path)`.
+    /// An awaiting coroutine is resumed through executor, if it is set.
+    /// The File must not be modified until the result is ready.
+    /// The worker sets the error of the File, so even on a const File
+    /// only one write may run at a time.
+    [[nodiscard]]
+    AsyncResult async_write(std::filesystem::path file, Executor executor = {}) const;
+
     /// Read from a string and decode it.
     /// Return false iff error happen.
     /// Run File::error() for mare information.
@@ -157,12 +440,102 @@ class File: public std::map<std::string, Section>
     /// Write to std::ostream.
     void encode(std::ostream& output) const;
 
+    /// Read from a string and decode it, without stopping at the first error.
+    /// Bad lines are skipped and every problem is appended to `diagnostics`.
+    /// Return false iff error happen.
+    bool decode(std::string_view str, std::vector<Diagnostic>& diagnostics);
+
+    /// Read from std::istream and decode it, without stopping at the first error.
+    /// Bad lines are skipped and every problem is appended to `diagnostics`.
+    /// Return false iff error happen.
+    bool decode(std::istream& input, std::vector<Diagnostic>& diagnostics);
+
+    /// Set the limits applied by File::read() and File::decode().
+    void set_limits(Limits const& limits) { limits_ = limits; }
+
+    /// Get the limits applied by File::read() and File::decode().
+    [[nodiscard]]
+    Limits const& limits() const { return limits_; }
+
+    /// Get all sections whose name starts with prefix, in O(log n).
+    [[nodiscard]]
+    std::ranges::subrange<iterator> sections_with_prefix(std::string_view prefix);
+    [[nodiscard]]
+    std::ranges::subrange<const_iterator> sections_with_prefix(std::string_view prefix) const;
+
+    /// Get all sections whose name matches a glob pattern like "backend:*".
+    /// Only the names starting with the part before the first wildcard are checked.
+    [[nodiscard]]
+    std::vector<const_iterator> sections_matching(std::string_view pattern) const;
+
+    /// Get a hash of all sections, built on Section::fingerprint().
+    /// Two Files with the same content have the same fingerprint.
+    [[nodiscard]]
+    std::uint64_t fingerprint() const;
+
+    /// Get the heap used by all sections, keys and values.
+    [[nodiscard]]
+    MemoryUsage memory_usage() const;
+
+    /// Rebuild all sections with exactly sized strings and nodes allocated in order,
+    /// then free the old ones.
+    /// This removes string slack only. Every key still takes one std::map node,
+    /// and whether the new nodes are adjacent in memory depends on the allocator.
+    /// All iterators and references into the File are invalidated.
+    void compact();
+
     /// Get the detailed error description.
     [[nodiscard]]
     std::string_view eroor() const { return error_; }
 
   private:
+    /// Decode lines produced by `next_line(std::string_view&)` until it returns LineStatus::End.
+    /// Stop at the first error iff `diagnostics` is null.
+    template<typename NextLine>
+    bool decode_lines(NextLine&& next_line, std::vector<Diagnostic>* diagnostics);
+
     mutable std::string error_;
+    Limits limits_;
+};
+
+/**
+ * Write many files atomically, paying for one directory sync per directory.
+ *
+ * Every file is written into a temporary file first.
+ * They are renamed over their targets only after all of them have been written.
+ */
+class BatchWriter
+{
+  public:
+    /// Flush files and directories to disk on commit iff `sync` is true.
+    explicit BatchWriter(bool sync = true): sync_(sync) {}
+
+    /// Encode file now and schedule it to be written to path.
+    /// Adding a path that is already scheduled replaces its content.
+    void add(File const& file, std::filesystem::path path);
+
+    /// Write all scheduled files.
+    /// Return false iff error happen, and then no target is touched
+    /// unless the error happen while renaming.
+    /// Run BatchWriter::error() for more information.
+    bool commit();
+
+    /// Get the detailed error description.
+    [[nodiscard]]
+    std::string_view error() const { return error_; }
+
+  private:
+    struct Pending
+    {
+        std::filesystem::path path;
+        /// Canonical form of path, to find repeated targets.
+        std::filesystem::path identity;
+        std::string content;
+    };
+
+    bool sync_;
+    std::vector<Pending> pending_;
+    std::string error_;
 };
 
 } // namespace ini
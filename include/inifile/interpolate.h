@@ -0,0 +1,116 @@
+#pragma once
+
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "inifile/inifile.h"
+
+namespace ini
+{
+
+struct InterpolationError: std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Bounds of the expansions done by an Interpolator.
+ * References may expand exponentially, like `a = ${A:b}${A:b}` and `b = ${A:c}${A:c}`,
+ * so untrusted files need both.
+ */
+struct InterpolationLimits
+{
+    static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+
+    /// Bytes of one expanded value.
+    std::size_t max_value_size = std::size_t{1} << 20;
+    /// Bytes of all cached expanded values together.
+    std::size_t max_total_size = std::size_t{64} << 20;
+};
+
+/**
+ * Expand `${section:key}` and `${ENV}` references in the values of a File.
+ *
+ * References are parsed into a dependency graph once, on construction.
+ * A value is expanded on its first access and then cached,
+ * and values without references are returned without a copy.
+ * A `${` without a closing `}` is kept as plain text.
+ * The key follows the last `:`, so section names may contain `:` but keys may not.
+ * Expansion is iterative, so long reference chains do not overflow the stack.
+ */
+class Interpolator
+{
+  public:
+    /// Build the dependency graph of file.
+    /// The File must outlive the Interpolator.
+    explicit Interpolator(File const& file, InterpolationLimits const& limits = {});
+
+    Interpolator(Interpolator const&) = delete;
+    Interpolator& operator=(Interpolator const&) = delete;
+
+    /// Get the expanded value of key in section.
+    /// Throw InterpolationError if the key, a reference or an environment variable is missing,
+    /// if a reference cycle is found, or if an expansion exceeds the limits.
+    [[nodiscard]]
+    Field const& get(std::string_view section, std::string_view key);
+
+    /// Notify that key in section has been assigned, added or erased in the File.
+    /// Only the cached expansions depending on it are dropped.
+    void invalidate(std::string_view section, std::string_view key);
+
+  private:
+    struct Node;
+
+    /// A piece of a value: either plain text, a reference or an environment variable.
+    struct Segment
+    {
+        std::string_view text;
+        Node* reference = nullptr;
+        bool environment = false;
+    };
+
+    struct Node
+    {
+        std::string_view section;
+        std::string_view key;
+        /// Null iff the key does not exist in the File.
+        Field const* source = nullptr;
+        std::vector<Segment> segments;
+        std::vector<Node*> dependents;
+        /// Expanded value, iff it has any reference.
+        std::optional<Field> expanded;
+        /// Points to either `source` or `expanded` once expanded.
+        Field const* result = nullptr;
+        /// Set while expanding, to find cycles.
+        bool visiting = false;
+    };
+
+    Node& node(std::string_view section, std::string_view key);
+
+    /// Parse the references of node from its source.
+    void link(Node& node);
+
+    /// Drop links from node to its references.
+    void unlink(Node& node);
+
+    Field const& expand(Node& node);
+
+    /// Expand node, whose references are all expanded already.
+    void expand_segments(Node& node);
+
+    /// Drop cached expansions of node and of all its dependents.
+    void drop(Node& node);
+
+    File const& file_;
+    InterpolationLimits limits_;
+    /// Bytes of all `expanded` values.
+    std::size_t total_size_ = 0;
+    std::map<std::string, std::map<std::string, Node, std::less<>>, std::less<>> nodes_;
+};
+
+} // namespace ini
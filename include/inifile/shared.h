@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "inifile/inifile.h"
+
+namespace ini
+{
+
+/**
+ * Publish a File into a POSIX shared-memory segment,
+ * so that many processes read one copy of it.
+ *
+ * The segment holds two slots of position-independent records.
+ * A new version is written into the inactive slot and then made active
+ * by bumping a generation counter, so readers are never blocked.
+ *
+ * Only available on POSIX systems.
+ */
+class SharedPublisher
+{
+  public:
+    SharedPublisher() = default;
+    SharedPublisher(SharedPublisher const&) = delete;
+    SharedPublisher& operator=(SharedPublisher const&) = delete;
+    ~SharedPublisher();
+
+    /// Create the segment `name` (like "/config"), able to hold a document of `capacity` bytes.
+    /// The segment gets the permission bits `mode`, only readable by its owner by default,
+    /// as documents often hold secrets.
+    /// An existing segment of the same capacity is reused, so attached subscribers keep working.
+    /// One of another capacity is marked as superseded and replaced,
+    /// and subscribers have to open it again.
+    /// Return false iff error happen.
+    /// Run SharedPublisher::error() for more information.
+    bool open(std::string const& name, std::size_t capacity, unsigned mode = 0600);
+
+    /// Publish a new version of file.
+    /// Return false iff error happen, such as a document larger than the capacity.
+    /// Run SharedPublisher::error() for more information.
+    bool publish(File const& file);
+
+    /// Remove the segment `name`. Attached subscribers keep their mapping.
+    static bool remove(std::string const& name);
+
+    /// Get the detailed error description.
+    [[nodiscard]]
+    std::string_view error() const { return error_; }
+
+  private:
+    void close();
+
+    std::byte* memory_ = nullptr;
+    std::size_t size_ = 0;
+    std::string error_;
+};
+
+/**
+ * Read a File published by SharedPublisher, from any process.
+ *
+ * Reads are lock-free and retried if a new version is published meanwhile.
+ */
+class SharedSubscriber
+{
+  public:
+    SharedSubscriber() = default;
+    SharedSubscriber(SharedSubscriber const&) = delete;
+    SharedSubscriber& operator=(SharedSubscriber const&) = delete;
+    ~SharedSubscriber();
+
+    /// Attach to the segment `name` read-only.
+    /// Return false iff error happen.
+    /// Run SharedSubscriber::error() for more information.
+    bool open(std::string const& name);
+
+    /// Get the number of versions published, 0 if nothing is published yet.
+    [[nodiscard]]
+    std::uint64_t generation() const;
+
+    /// Check whether the publisher has replaced the segment by a new one.
+    /// The current version stays readable, but no new version will come:
+    /// run SharedSubscriber::open() again to follow the publisher.
+    [[nodiscard]]
+    bool superseded() const;
+
+    /// Get the value of key in section from the current version, or nothing if it is missing.
+    [[nodiscard]]
+    std::optional<std::string> find(std::string_view section, std::string_view key) const;
+
+    /// Copy the current version into file.
+    /// Return false iff nothing is published yet.
+    bool load(File& file) const;
+
+    /// Get the detailed error description.
+    [[nodiscard]]
+    std::string_view error() const { return error_; }
+
+  private:
+    void close();
+
+    std::byte const* memory_ = nullptr;
+    std::size_t size_ = 0;
+    std::string error_;
+};
+
+} // namespace ini
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include "inifile/inifile.h"
+#include "inifile/stralgo.h"
+
+namespace ini
+{
+
+/**
+ * A key-value pair of StaticFile.
+ * All strings refer to the text it is decoded from.
+ */
+struct StaticEntry
+{
+    std::string_view section;
+    std::string_view key;
+    std::string_view value;
+};
+
+/**
+ * An immutable ini file decoded at compile time,
+ * stored as an array of entries sorted by section and key.
+ *
+ * Usage:
+ *     constexpr std::string_view TEXT = "[server]\nport = 8080\n";
+ *     constexpr auto DEFAULTS = ini::static_decode<ini::static_capacity(TEXT)>(TEXT);
+ *     static_assert(DEFAULTS.get<int>("server", "port") == 8080);
+ */
+template<std::size_t Capacity>
+class StaticFile
+{
+  public:
+    /// Get the value of key in section, or nothing if it is missing.
+    [[nodiscard]]
+    constexpr std::optional<std::string_view> find(std::string_view section, std::string_view key) const
+    {
+        std::size_t low = 0;
+        std::size_t high = size_;
+        while (low < high)
+        {
+            auto middle = low + (high - low) / 2;
+            if (less(entries_[middle], section, key))
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        if (low != size_ && entries_[low].section == section && entries_[low].key == key)
+        {
+            return entries_[low].value;
+        }
+        return std::nullopt;
+    }
+
+    /// Convert the value of key in section into type `T`.
+    /// `T` is std::string_view, bool or an integral type.
+    /// Throw DecodeError if the key is missing or can not be converted,
+    /// which fails the compilation in a constant expression.
+    template<typename T>
+    [[nodiscard]]
+    constexpr T get(std::string_view section, std::string_view key) const
+    {
+        auto value = find(section, key);
+        if (!value)
+        {
+            throw DecodeError("Key not found in static file.");
+        }
+
+        if constexpr (std::is_same_v<T, std::string_view>)
+        {
+            return *value;
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            if (*value == "true" || *value == "True")
+            {
+                return true;
+            }
+            if (*value == "false" || *value == "False")
+            {
+                return false;
+            }
+            throw DecodeError("Failed to decode bool in static file.");
+        }
+        else
+        {
+            static_assert(std::is_integral_v<T>, "Only std::string_view, bool and integral types are supported.");
+            return decode_integral<T>(*value);
+        }
+    }
+
+    /// Number of key-value pairs.
+    [[nodiscard]]
+    constexpr std::size_t size() const { return size_; }
+
+    [[nodiscard]]
+    constexpr StaticEntry const* begin() const { return entries_.data(); }
+
+    [[nodiscard]]
+    constexpr StaticEntry const* end() const { return entries_.data() + size_; }
+
+  private:
+    template<std::size_t N>
+    friend consteval StaticFile<N> static_decode(std::string_view text);
+
+    static constexpr bool less(StaticEntry const& entry, std::string_view section, std::string_view key)
+    {
+        return entry.section < section || (entry.section == section && entry.key < key);
+    }
+
+    /// Same rules as std::from_chars() in decimal, which Decoder uses at runtime.
+    template<typename T>
+    static constexpr T decode_integral(std::string_view str)
+    {
+        bool negative = std::is_signed_v<T> && !str.empty() && str.front() == '-';
+        std::size_t pos = negative ? 1 : 0;
+        if (pos == str.size() || str[pos] < '0' || str[pos] > '9')
+        {
+            throw DecodeError("Failed to decode a number type in static file. Error: Invalid argument.");
+        }
+
+        // Accumulate towards the sign, so that the minimum of T is reachable.
+        T number = 0;
+        for (; pos < str.size() && str[pos] >= '0' && str[pos] <= '9'; ++pos)
+        {
+            T digit = static_cast<T>(str[pos] - '0');
+            if (negative
+                ? number < (std::numeric_limits<T>::min() + digit) / 10
+                : number > (std::numeric_limits<T>::max() - digit) / 10)
+            {
+                throw DecodeError("Failed to decode a number type in static file. Error: result out of range");
+            }
+            number = static_cast<T>(negative ? number * 10 - digit : number * 10 + digit);
+        }
+        return number;
+    }
+
+    std::array<StaticEntry, Capacity> entries_{};
+    std::size_t size_ = 0;
+};
+
+/// Get the capacity needed to decode text with static_decode().
+[[nodiscard]]
+consteval std::size_t static_capacity(std::string_view text)
+{
+    std::size_t lines = 1;
+    for (char c : text)
+    {
+        lines += c == '\n' ? 1 : 0;
+    }
+    return lines;
+}
+
+/// Decode text at compile time with the same rules as File::decode().
+/// A syntax error fails the compilation.
+template<std::size_t Capacity>
+[[nodiscard]]
+consteval StaticFile<Capacity> static_decode(std::string_view text)
+{
+    StaticFile<Capacity> file;
+    std::string_view section;
+
+    while (!text.empty())
+    {
+        auto pos = text.find('\n');
+        auto line = str::erase_comments(text.substr(0, pos));
+        text = pos == std::string_view::npos ? std::string_view{} : text.substr(pos + 1);
+
+        if (auto name = str::extract_section_name(line); !name.empty())
+        {
+            section = name;
+            continue;
+        }
+
+        if (auto [key, value] = str::extract_key_value(line); !key.empty())
+        {
+            if (section.empty())
+            {
+                throw DecodeError("Syntax error in static file: Expected a section name");
+            }
+
+            // Insertion sort, keeping the input order of equal keys.
+            auto entry = StaticEntry{.section = section, .key = key, .value = value};
+            auto index = file.size_++;
+            for (; index > 0 && StaticFile<Capacity>::less(entry, file.entries_[index - 1].section, file.entries_[index - 1].key); --index)
+            {
+                file.entries_[index] = file.entries_[index - 1];
+            }
+            file.entries_[index] = entry;
+            continue;
+        }
+
+        if (!str::is_empty_line(line))
+        {
+            throw DecodeError("Syntax error in static file");
+        }
+    }
+
+    // Keep only the last one of duplicated keys, like File::decode().
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < file.size_; ++i)
+    {
+        auto const& entry = file.entries_[i];
+        bool duplicated = i + 1 < file.size_
+                       && file.entries_[i + 1].section == entry.section
+                       && file.entries_[i + 1].key == entry.key;
+        if (!duplicated)
+        {
+            file.entries_[size++] = entry;
+        }
+    }
+    file.size_ = size;
+
+    return file;
+}
+
+} // namespace ini
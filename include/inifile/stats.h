@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <typeindex>
+#include <typeinfo>
+
+/// Instrumentation is compiled in iff INI_ENABLE_STATS is defined,
+/// which is done by `xmake f --stats=y`.
+/// Otherwise every hook compiles to nothing and no statistic is recorded.
+
+namespace ini::stats
+{
+
+/// Whether instrumentation is compiled in.
+#ifdef INI_ENABLE_STATS
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+/**
+ * Counters and timings of File::decode().
+ */
+struct ParseStats
+{
+    /// Bytes scanned, including line breaks.
+    std::uint64_t bytes = 0;
+    /// Lines scanned.
+    std::uint64_t lines = 0;
+    /// Sections inserted into the File.
+    std::uint64_t sections = 0;
+    /// Keys inserted into a Section.
+    std::uint64_t keys = 0;
+    /// Estimated heap allocations: map nodes and strings too long for small-string storage.
+    std::uint64_t allocations = 0;
+    /// Calls that returned false.
+    std::uint64_t failures = 0;
+
+    /// Time spent splitting lines into sections and key-value pairs.
+    std::chrono::nanoseconds tokenize_time{};
+    /// Time spent inserting into the maps.
+    std::chrono::nanoseconds insert_time{};
+
+    ParseStats& operator+=(ParseStats const& other);
+};
+
+/**
+ * Statistics accumulated since program start or the last reset().
+ */
+struct Snapshot
+{
+    /// Sum over all File::decode() calls.
+    ParseStats parse;
+    /// Calls of File::decode().
+    std::uint64_t decodes = 0;
+    /// Failed Field::to<T>() calls, keyed by `typeid(T)`.
+    std::map<std::type_index, std::uint64_t> conversion_failures;
+};
+
+/// Get accumulated statistics.
+[[nodiscard]]
+Snapshot snapshot();
+
+/// Clear accumulated statistics.
+void reset();
+
+/// Register a function called with the statistics of every single File::decode().
+/// Pass an empty function to unregister it.
+void set_callback(std::function<void(ParseStats const&)> callback);
+
+/// Record a finished File::decode().
+void record_parse(ParseStats const& stats);
+
+/// Record a failed Field::to<T>().
+void record_conversion_failure(std::type_info const& type);
+
+} // namespace ini::stats
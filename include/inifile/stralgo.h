@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string_view>
+
+/// String algorithms shared by File::decode() and the compile-time parser.
+/// They are all constexpr, so they live in this header.
+
+namespace ini::str
+{
+
+namespace detail
+{
+    using SizeType = std::string_view::size_type;
+
+    /// substr() method for std::string_view with [begin, end).
+    constexpr std::string_view substr(std::string_view str, SizeType begin, SizeType end)
+    {
+        return str.substr(begin, end - begin);
+    }
+
+    constexpr std::string_view BLANK_CHARS {" \t\r\n"};
+} // namespace detail
+
+/// Remove blank chars beside.
+[[nodiscard]]
+constexpr std::string_view trim(std::string_view str)
+{
+    auto begin = str.find_first_not_of(detail::BLANK_CHARS);
+    auto before_end = str.find_last_not_of(detail::BLANK_CHARS);
+
+    if (begin == std::string_view::npos)
+    {
+        return std::string_view{};
+    }
+    return detail::substr(str, begin, before_end + 1);
+}
+
+/// Judge if str is of mode "[section]".
+/// If true, return the name of the section.
+/// If false, return an empty string.
+[[nodiscard]]
+constexpr std::string_view extract_section_name(std::string_view str)
+{
+    str = trim(str);
+    if (str.size() > 2 && str.front() == '[' && str.back() == ']')
+    {
+        return trim(detail::substr(str, 1, str.size() - 1));
+    }
+    return std::string_view{};
+}
+
+struct KeyValue
+{
+    std::string_view key;
+    std::string_view value;
+};
+/// Judge if str is of mode "key=value"
+/// If true, return the key-value pair.
+/// If false, return two empty string.
+[[nodiscard]]
+constexpr KeyValue extract_key_value(std::string_view str)
+{
+    if (auto pos = str.find_first_of('='); pos != std::string_view::npos)
+    {
+        return KeyValue{
+            .key   = trim(detail::substr(str, 0, pos)),
+            .value = trim(detail::substr(str, pos + 1, str.size() + 1)),
+        };
+    }
+    return KeyValue{};
+}
+
+/// Erase all comments in the line,
+/// which begins with '#' or ';'.
+[[nodiscard]]
+constexpr std::string_view erase_comments(std::string_view str)
+{
+    if (auto pos = str.find_first_of("#;"); pos != std::string_view::npos)
+    {
+        return detail::substr(str, 0, pos);
+    }
+    return str;
+}
+
+/// Jedge if a line is made of blank char.
+[[nodiscard]]
+constexpr bool is_empty_line(std::string_view str)
+{
+    return str.find_first_not_of(detail::BLANK_CHARS) == std::string_view::npos;
+}
+
+/// Judge if str matches a glob pattern,
+/// where '*' matches any chars and '?' matches a single char.
+[[nodiscard]]
+constexpr bool glob_match(std::string_view pattern, std::string_view str)
+{
+    detail::SizeType p = 0;
+    detail::SizeType s = 0;
+    detail::SizeType star = std::string_view::npos; // position of the last '*' in pattern.
+    detail::SizeType retry = 0;                     // position in str to retry after the last '*'.
+
+    while (s < str.size())
+    {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == str[s]))
+        {
+            ++p;
+            ++s;
+        }
+        else if (p < pattern.size() && pattern[p] == '*')
+        {
+            star = p++;
+            retry = s;
+        }
+        else if (star != std::string_view::npos)
+        {
+            p = star + 1;
+            s = ++retry;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*')
+    {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+/// Get the part of pattern before the first wildcard.
+[[nodiscard]]
+constexpr std::string_view glob_prefix(std::string_view pattern)
+{
+    return pattern.substr(0, pattern.find_first_of("*?"));
+}
+
+} // namespace ini::str
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+
+#include "inifile/inifile.h"
+
+namespace ini
+{
+
+/**
+ * Stream ini text into std::ostream without building a File.
+ *
+ * The output has the same format as File::encode(),
+ * so sections and keys written in sorted order give identical text.
+ * Values are formatted by Encoder<T> without any allocation.
+ */
+class Writer
+{
+  public:
+    explicit Writer(std::ostream& output): output_(output) {}
+
+    Writer(Writer const&) = delete;
+    Writer& operator=(Writer const&) = delete;
+
+    /// Finish the output.
+    ~Writer() { finish(); }
+
+    /// Start a new section.
+    Writer& section(std::string_view name);
+
+    /// Write a key-value pair into the current section.
+    /// It must be called after section().
+    template<typename T>
+    Writer& kv(std::string_view key, T const& value)
+    {
+        EncodeBuffer buffer;
+        return put(key, Encoder<T>::encode(value, buffer));
+    }
+
+    /// Close the current section and flush the buffer into the stream.
+    void finish();
+
+    /// Flush the buffer into the stream.
+    void flush();
+
+  private:
+    Writer& put(std::string_view key, std::string_view value);
+
+    /// Append to the buffer, flushing it when full.
+    void append(std::string_view str);
+
+    std::ostream& output_;
+    std::array<char, 8192> buffer_{};
+    std::size_t size_ = 0;
+    bool in_section_ = false;
+};
+
+} // namespace ini
@@ -0,0 +1,364 @@
+#include "inifile/diff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace
+{
+    /// Get the value of key in section, or nothing if it is missing.
+    std::optional<std::string_view> lookup(ini::File const& file, std::string_view section, std::string_view key)
+    {
+        auto section_it = file.find(section);
+        if (section_it == file.end())
+        {
+            return std::nullopt;
+        }
+        auto key_it = section_it->second.find(key);
+        if (key_it == section_it->second.end())
+        {
+            return std::nullopt;
+        }
+        return std::string_view(key_it->second.as_str());
+    }
+
+    bool equal(ini::Section const& lhs, ini::Section const& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](auto const& left, auto const& right) {
+            return left.first == right.first && left.second.as_str() == right.second.as_str();
+        });
+    }
+
+    /// Get changes between two versions of the same section.
+    std::vector<ini::KeyChange> diff_section(ini::Section const& from, ini::Section const& to)
+    {
+        using Kind = ini::KeyChange::Kind;
+        std::vector<ini::KeyChange> changes;
+
+        auto from_it = from.begin();
+        auto to_it = to.begin();
+
+        while (from_it != from.end() || to_it != to.end())
+        {
+            if (to_it == to.end() || (from_it != from.end() && from_it->first < to_it->first))
+            {
+                changes.push_back(ini::KeyChange{.kind = Kind::Remove, .key = from_it->first, .value = {}});
+                ++from_it;
+            }
+            else if (from_it == from.end() || to_it->first < from_it->first)
+            {
+                changes.push_back(ini::KeyChange{.kind = Kind::Add, .key = to_it->first, .value = to_it->second.as_str()});
+                ++to_it;
+            }
+            else
+            {
+                if (from_it->second.as_str() != to_it->second.as_str())
+                {
+                    changes.push_back(ini::KeyChange{.kind = Kind::Change, .key = to_it->first, .value = to_it->second.as_str()});
+                }
+                ++from_it;
+                ++to_it;
+            }
+        }
+        return changes;
+    }
+
+    /// Apply one key change to a section of file.
+    void apply_key(ini::File& file, std::string const& section, ini::KeyChange const& change)
+    {
+        if (change.kind == ini::KeyChange::Kind::Remove)
+        {
+            if (auto it = file.find(section); it != file.end())
+            {
+                it->second.erase(change.key);
+            }
+        }
+        else
+        {
+            file[section][change.key] = change.value;
+        }
+    }
+
+    /// First bytes of an encoded patch, with its format version.
+    constexpr std::string_view PATCH_MAGIC = "INIP\x01";
+
+    /// Append value as LEB128: 7 bits per byte, the high bit set on all but the last.
+    void put_size(std::string& output, std::size_t value)
+    {
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<char>(value));
+    }
+
+    void put_string(std::string& output, std::string_view str)
+    {
+        put_size(output, str.size());
+        output.append(str);
+    }
+
+    /// Bounds-checked reads from an encoded patch.
+    class PatchReader
+    {
+      public:
+        explicit PatchReader(std::string_view data): rest_(data) {}
+
+        [[nodiscard]]
+        bool empty() const { return rest_.empty(); }
+
+        [[nodiscard]]
+        std::size_t remain() const { return rest_.size(); }
+
+        bool byte(std::uint8_t& value)
+        {
+            if (rest_.empty())
+            {
+                return false;
+            }
+            value = static_cast<std::uint8_t>(rest_.front());
+            rest_.remove_prefix(1);
+            return true;
+        }
+
+        bool size(std::size_t& value)
+        {
+            value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                std::uint8_t byte_value{};
+                if (!byte(byte_value))
+                {
+                    return false;
+                }
+                value |= static_cast<std::size_t>(byte_value & 0x7F) << shift;
+                if ((byte_value & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool string(std::string& value)
+        {
+            std::size_t length{};
+            if (!size(length) || length > rest_.size())
+            {
+                return false;
+            }
+            value = rest_.substr(0, length);
+            rest_.remove_prefix(length);
+            return true;
+        }
+
+        bool skip(std::string_view prefix)
+        {
+            if (!rest_.starts_with(prefix))
+            {
+                return false;
+            }
+            rest_.remove_prefix(prefix.size());
+            return true;
+        }
+
+      private:
+        std::string_view rest_;
+    };
+} // anonymous namespace
+
+namespace ini
+{
+
+Patch diff(File const& from, File const& to)
+{
+    using Kind = SectionChange::Kind;
+    Patch patch;
+    Section const empty;
+
+    auto from_it = from.begin();
+    auto to_it = to.begin();
+
+    while (from_it != from.end() || to_it != to.end())
+    {
+        if (to_it == to.end() || (from_it != from.end() && from_it->first < to_it->first))
+        {
+            patch.push_back(SectionChange{.kind = Kind::Remove, .section = from_it->first, .keys = {}});
+            ++from_it;
+        }
+        else if (from_it == from.end() || to_it->first < from_it->first)
+        {
+            patch.push_back(SectionChange{.kind = Kind::Add, .section = to_it->first, .keys = diff_section(empty, to_it->second)});
+            ++to_it;
+        }
+        else
+        {
+            if (auto keys = diff_section(from_it->second, to_it->second); !keys.empty())
+            {
+                patch.push_back(SectionChange{.kind = Kind::Modify, .section = to_it->first, .keys = std::move(keys)});
+            }
+            ++from_it;
+            ++to_it;
+        }
+    }
+    return patch;
+}
+
+void apply(File& file, Patch const& patch)
+{
+    for (auto const& change : patch)
+    {
+        switch (change.kind)
+        {
+            case SectionChange::Kind::Remove:
+                if (auto it = file.find(change.section); it != file.end())
+                {
+                    file.erase(it);
+                }
+                break;
+
+            case SectionChange::Kind::Add:
+                file.try_emplace(change.section);
+                [[fallthrough]];
+
+            case SectionChange::Kind::Modify:
+                for (auto const& key : change.keys)
+                {
+                    apply_key(file, change.section, key);
+                }
+                break;
+        }
+    }
+}
+
+std::string encode_patch(Patch const& patch)
+{
+    std::string output(PATCH_MAGIC);
+    put_size(output, patch.size());
+    for (auto const& change : patch)
+    {
+        output.push_back(static_cast<char>(change.kind));
+        put_string(output, change.section);
+        put_size(output, change.keys.size());
+        for (auto const& key : change.keys)
+        {
+            output.push_back(static_cast<char>(key.kind));
+            put_string(output, key.key);
+            if (key.kind != KeyChange::Kind::Remove)
+            {
+                put_string(output, key.value);
+            }
+        }
+    }
+    return output;
+}
+
+std::optional<Patch> decode_patch(std::string_view data)
+{
+    PatchReader reader(data);
+    std::size_t section_count{};
+    if (!reader.skip(PATCH_MAGIC) || !reader.size(section_count))
+    {
+        return std::nullopt;
+    }
+
+    // Counts are untrusted, so reserve no more than the bytes left could hold.
+    Patch patch;
+    patch.reserve(std::min(section_count, reader.remain()));
+    for (std::size_t i = 0; i < section_count; ++i)
+    {
+        std::uint8_t kind{};
+        std::size_t key_count{};
+        auto& change = patch.emplace_back();
+        if (!reader.byte(kind) || kind > static_cast<std::uint8_t>(SectionChange::Kind::Modify)
+            || !reader.string(change.section) || !reader.size(key_count))
+        {
+            return std::nullopt;
+        }
+        change.kind = static_cast<SectionChange::Kind>(kind);
+        if (change.kind == SectionChange::Kind::Remove && key_count != 0)
+        {
+            return std::nullopt;
+        }
+
+        change.keys.reserve(std::min(key_count, reader.remain()));
+        for (std::size_t j = 0; j < key_count; ++j)
+        {
+            auto& key = change.keys.emplace_back();
+            if (!reader.byte(kind) || kind > static_cast<std::uint8_t>(KeyChange::Kind::Remove) || !reader.string(key.key))
+            {
+                return std::nullopt;
+            }
+            key.kind = static_cast<KeyChange::Kind>(kind);
+            if (key.kind != KeyChange::Kind::Remove && !reader.string(key.value))
+            {
+                return std::nullopt;
+            }
+        }
+    }
+
+    if (!reader.empty())
+    {
+        return std::nullopt;
+    }
+    return patch;
+}
+
+MergeResult merge(File const& base, File const& ours, File const& theirs)
+{
+    MergeResult result{.file = ours, .conflicts = {}};
+
+    for (auto const& change : diff(base, theirs))
+    {
+        auto base_section = base.find(change.section);
+        auto our_section = ours.find(change.section);
+
+        if (change.kind == SectionChange::Kind::Remove)
+        {
+            if (our_section != ours.end() && !equal(our_section->second, base_section->second))
+            {
+                result.conflicts.push_back(Conflict{.section = change.section, .key = {}});
+                continue;
+            }
+            ini::apply(result.file, Patch{change});
+            continue;
+        }
+
+        // Keys changed by them in a section removed by us.
+        if (base_section != base.end() && our_section == ours.end())
+        {
+            result.conflicts.push_back(Conflict{.section = change.section, .key = {}});
+            continue;
+        }
+
+        if (change.kind == SectionChange::Kind::Add)
+        {
+            result.file.try_emplace(change.section);
+        }
+
+        for (auto const& key : change.keys)
+        {
+            auto base_value = lookup(base, change.section, key.key);
+            auto our_value = lookup(ours, change.section, key.key);
+            std::optional<std::string_view> their_value;
+            if (key.kind != KeyChange::Kind::Remove)
+            {
+                their_value = key.value;
+            }
+
+            if (our_value == base_value)
+            {
+                apply_key(result.file, change.section, key);
+            }
+            else if (our_value != their_value)
+            {
+                result.conflicts.push_back(Conflict{.section = change.section, .key = key.key});
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace ini
@@ -0,0 +1,317 @@
+#include "fileio.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <random>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#include "fmt/format.h"
+
+namespace
+{
+#ifndef _WIN32
+    /// Close fd on scope exit.
+    class FdGuard
+    {
+      public:
+        explicit FdGuard(int fd): fd_(fd) {}
+        FdGuard(FdGuard const&) = delete;
+        FdGuard& operator=(FdGuard const&) = delete;
+        ~FdGuard()
+        {
+            if (fd_ >= 0)
+            {
+                ::close(fd_);
+            }
+        }
+
+        /// Close now and report the result.
+        bool close()
+        {
+            int fd = fd_;
+            fd_ = -1;
+            return ::close(fd) == 0;
+        }
+
+      private:
+        int fd_;
+    };
+
+    std::string describe(std::string_view what, std::filesystem::path const& file)
+    {
+        return fmt::format("{} at {}: {}", what, file.string(), std::strerror(errno));
+    }
+
+    /// Write the concatenation of chunks to fd, then flush and close it.
+    bool write_all(FdGuard& guard, int fd, std::span<std::string_view const> chunks, bool sync, std::filesystem::path const& file, std::string& error)
+    {
+        std::vector<iovec> vectors;
+        vectors.reserve(chunks.size());
+        for (auto chunk : chunks)
+        {
+            if (!chunk.empty())
+            {
+                vectors.push_back(iovec{.iov_base = const_cast<char*>(chunk.data()), .iov_len = chunk.size()});
+            }
+        }
+
+        // At most IOV_MAX buffers per call, and a call may stop in the middle of any of them.
+        auto* next = vectors.data();
+        auto* end = vectors.data() + vectors.size();
+        while (next != end)
+        {
+            auto count = static_cast<int>(std::min<std::ptrdiff_t>(end - next, IOV_MAX));
+            auto written = ::writev(fd, next, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                error = describe("Failed to write file", file);
+                return false;
+            }
+
+            auto remain = static_cast<std::size_t>(written);
+            while (next != end && remain >= next->iov_len)
+            {
+                remain -= next->iov_len;
+                ++next;
+            }
+            if (next != end)
+            {
+                next->iov_base = static_cast<char*>(next->iov_base) + remain;
+                next->iov_len -= remain;
+            }
+        }
+
+        if (sync && ::fsync(fd) != 0)
+        {
+            error = describe("Failed to sync file", file);
+            return false;
+        }
+
+        if (!guard.close())
+        {
+            error = describe("Failed to close file", file);
+            return false;
+        }
+        return true;
+    }
+
+    /// Give the file open at fd the mode of file, and its owner when permitted.
+    /// Nothing is done if file does not exist yet.
+    bool copy_attributes(int fd, std::filesystem::path const& file, std::filesystem::path const& temporary, std::string& error)
+    {
+        struct stat info{};
+        if (::stat(file.c_str(), &info) != 0)
+        {
+            return true;
+        }
+
+        // Only root may give a file away, so others end up owning the new file, as with any editor.
+        // It comes first, as changing the owner may clear the set-user-ID bit.
+        if ((info.st_uid != ::geteuid() || info.st_gid != ::getegid())
+            && ::fchown(fd, info.st_uid, info.st_gid) != 0 && errno != EPERM)
+        {
+            error = describe("Failed to change owner of file", temporary);
+            return false;
+        }
+        if (::fchmod(fd, info.st_mode & 07777) != 0)
+        {
+            error = describe("Failed to change mode of file", temporary);
+            return false;
+        }
+        return true;
+    }
+
+#endif
+
+    /// Get a random suffix for temporary files.
+    std::string random_suffix()
+    {
+        thread_local std::mt19937_64 engine(std::random_device{}());
+        return fmt::format("{:016x}", engine());
+    }
+} // anonymous namespace
+
+namespace ini::io
+{
+
+bool write_file(std::filesystem::path const& file, std::string_view data, bool sync, std::string& error)
+{
+    return write_file(file, std::span<std::string_view const>(&data, 1), sync, error);
+}
+
+#ifndef _WIN32
+
+bool write_file(std::filesystem::path const& file, std::span<std::string_view const> chunks, bool sync, std::string& error)
+{
+    int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error = describe("Failed to open file", file);
+        return false;
+    }
+    FdGuard guard(fd);
+    return write_all(guard, fd, chunks, sync, file, error);
+}
+
+bool write_temporary(std::filesystem::path const& file, std::span<std::string_view const> chunks, bool sync,
+                     std::filesystem::path& temporary, std::string& error)
+{
+    // O_EXCL never reuses or follows an existing file, so only a name collision needs a retry.
+    constexpr int ATTEMPTS = 16;
+    int fd = -1;
+    for (int attempt = 0; attempt < ATTEMPTS && fd < 0; ++attempt)
+    {
+        temporary = file;
+        temporary += fmt::format(".{}.tmp", random_suffix());
+        fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+        if (fd < 0 && errno != EEXIST)
+        {
+            break;
+        }
+    }
+    if (fd < 0)
+    {
+        error = describe("Failed to create temporary file", temporary);
+        return false;
+    }
+    FdGuard guard(fd);
+
+    if (!copy_attributes(fd, file, temporary, error) || !write_all(guard, fd, chunks, sync, temporary, error))
+    {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        return false;
+    }
+    return true;
+}
+
+bool sync_directory(std::filesystem::path const& directory, std::string& error)
+{
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = describe("Failed to open directory", directory);
+        return false;
+    }
+    FdGuard guard(fd);
+
+    if (::fsync(fd) != 0)
+    {
+        error = describe("Failed to sync directory", directory);
+        return false;
+    }
+    return true;
+}
+
+#else
+
+// Standard C++ only: there is no way to flush to disk, nor to create a file exclusively.
+
+bool write_file(std::filesystem::path const& file, std::span<std::string_view const> chunks, bool /*sync*/, std::string& error)
+{
+    std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+    for (auto chunk : chunks)
+    {
+        stream.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    }
+    stream.close();
+    if (!stream)
+    {
+        error = fmt::format("Failed to write file at {}", file.string());
+        return false;
+    }
+    return true;
+}
+
+bool write_temporary(std::filesystem::path const& file, std::span<std::string_view const> chunks, bool sync,
+                     std::filesystem::path& temporary, std::string& error)
+{
+    constexpr int ATTEMPTS = 16;
+    std::error_code code;
+    for (int attempt = 0; attempt < ATTEMPTS; ++attempt)
+    {
+        temporary = file;
+        temporary += fmt::format(".{}.tmp", random_suffix());
+        if (!std::filesystem::exists(temporary, code))
+        {
+            break;
+        }
+    }
+
+    std::error_code ignored;
+    if (!write_file(temporary, chunks, sync, error))
+    {
+        std::filesystem::remove(temporary, ignored);
+        return false;
+    }
+    if (auto status = std::filesystem::status(file, code); !code)
+    {
+        std::filesystem::permissions(temporary, status.permissions(), ignored);
+    }
+    return true;
+}
+
+bool sync_directory(std::filesystem::path const& /*directory*/, std::string& /*error*/)
+{
+    return true;
+}
+
+#endif
+
+std::filesystem::path resolve_symlinks(std::filesystem::path const& file)
+{
+    // The kernel gives up after 40 links as well, and then opening the result fails.
+    constexpr int MAX_LINKS = 40;
+    auto result = file;
+    for (int link = 0; link < MAX_LINKS; ++link)
+    {
+        std::error_code code;
+        if (!std::filesystem::is_symlink(result, code))
+        {
+            break;
+        }
+        auto target = std::filesystem::read_symlink(result, code);
+        if (code)
+        {
+            break;
+        }
+        result = target.is_absolute() ? target : result.parent_path() / target;
+    }
+    return result;
+}
+
+std::filesystem::path parent_directory(std::filesystem::path const& file)
+{
+    auto parent = file.parent_path();
+    return parent.empty() ? std::filesystem::path(".") : parent;
+}
+
+bool replace_file(std::filesystem::path const& from, std::filesystem::path const& to, std::string& error)
+{
+    std::error_code code;
+    std::filesystem::rename(from, to, code);
+    if (code)
+    {
+        error = fmt::format("Failed to rename {} to {}: {}", from.string(), to.string(), code.message());
+        return false;
+    }
+    return true;
+}
+
+} // namespace ini::io
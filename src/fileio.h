@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <span>
+#include <string_view>
+
+/**
+ * File operations for File::write() and BatchWriter.
+ *
+ * POSIX systems use open(), writev() and fsync().
+ * Elsewhere standard C++ streams are used, so `sync` has no effect
+ * and temporary files are not created exclusively.
+ */
+namespace ini::io
+{
+
+/// Write data to file with a single buffered write.
+/// Flush it to disk when `sync` is true.
+/// Return false iff error happen, and fill `error` with the description.
+[[nodiscard]]
+bool write_file(std::filesystem::path const& file, std::string_view data, bool sync, std::string& error);
+
+/// Write the concatenation of chunks to file with gathered writes.
+/// Flush it to disk when `sync` is true.
+/// Return false iff error happen, and fill `error` with the description.
+[[nodiscard]]
+bool write_file(std::filesystem::path const& file, std::span<std::string_view const> chunks, bool sync, std::string& error);
+
+/// Flush directory entries to disk, so that a rename inside it is durable.
+/// Return false iff error happen, and fill `error` with the description.
+[[nodiscard]]
+bool sync_directory(std::filesystem::path const& directory, std::string& error);
+
+/// Get the directory containing file, which is "." for a bare file name.
+[[nodiscard]]
+std::filesystem::path parent_directory(std::filesystem::path const& file);
+
+/// Write the concatenation of chunks to a new file next to file, with a random name.
+/// It gets the mode of file, and its owner when permitted, if file exists.
+/// The name is stored in `temporary`, and the file is removed again on failure.
+/// Flush it to disk when `sync` is true.
+/// Return false iff error happen, and fill `error` with the description.
+[[nodiscard]]
+bool write_temporary(std::filesystem::path const& file, std::span<std::string_view const> chunks, bool sync,
+                     std::filesystem::path& temporary, std::string& error);
+
+/// Follow symlinks until file is not one, so that a rename replaces the real file.
+[[nodiscard]]
+std::filesystem::path resolve_symlinks(std::filesystem::path const& file);
+
+/// Rename `from` over `to` atomically.
+/// Return false iff error happen, and fill `error` with the description.
+[[nodiscard]]
+bool replace_file(std::filesystem::path const& from, std::filesystem::path const& to, std::string& error);
+
+} // namespace ini::io
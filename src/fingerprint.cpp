@@ -0,0 +1,148 @@
+#include "inifile/inifile.h"
+
+#include <cstddef>
+
+namespace
+{
+    constexpr std::uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+    std::uint64_t rotl(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    /// Read a little-endian integer on any host.
+    /// Compilers turn this into a single load on little-endian machines.
+    template<typename T>
+    T read_le(char const* ptr)
+    {
+        T value{};
+        for (std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            value |= static_cast<T>(static_cast<unsigned char>(ptr[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    std::uint64_t read64(char const* ptr)
+    {
+        return read_le<std::uint64_t>(ptr);
+    }
+
+    std::uint32_t read32(char const* ptr)
+    {
+        return read_le<std::uint32_t>(ptr);
+    }
+
+    std::uint64_t round(std::uint64_t acc, std::uint64_t input)
+    {
+        return rotl(acc + input * PRIME_2, 31) * PRIME_1;
+    }
+
+    std::uint64_t merge_round(std::uint64_t acc, std::uint64_t value)
+    {
+        return (acc ^ round(0, value)) * PRIME_1 + PRIME_4;
+    }
+
+    std::uint64_t avalanche(std::uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    /// Mix value into an ordered hash.
+    std::uint64_t combine(std::uint64_t hash, std::uint64_t value)
+    {
+        return avalanche(round(hash, value));
+    }
+} // anonymous namespace
+
+namespace ini
+{
+
+// Reads are little-endian, as xxHash64 is specified on little-endian machines.
+std::uint64_t hash64(std::string_view data, std::uint64_t seed)
+{
+    char const* ptr = data.data();
+    char const* const end = ptr + data.size();
+    std::uint64_t hash{};
+
+    if (data.size() >= 32)
+    {
+        std::uint64_t acc1 = seed + PRIME_1 + PRIME_2;
+        std::uint64_t acc2 = seed + PRIME_2;
+        std::uint64_t acc3 = seed;
+        std::uint64_t acc4 = seed - PRIME_1;
+
+        for (; end - ptr >= 32; ptr += 32)
+        {
+            acc1 = round(acc1, read64(ptr));
+            acc2 = round(acc2, read64(ptr + 8));
+            acc3 = round(acc3, read64(ptr + 16));
+            acc4 = round(acc4, read64(ptr + 24));
+        }
+
+        hash = rotl(acc1, 1) + rotl(acc2, 7) + rotl(acc3, 12) + rotl(acc4, 18);
+        hash = merge_round(hash, acc1);
+        hash = merge_round(hash, acc2);
+        hash = merge_round(hash, acc3);
+        hash = merge_round(hash, acc4);
+    }
+    else
+    {
+        hash = seed + PRIME_5;
+    }
+
+    hash += data.size();
+
+    for (; end - ptr >= 8; ptr += 8)
+    {
+        hash ^= round(0, read64(ptr));
+        hash = rotl(hash, 27) * PRIME_1 + PRIME_4;
+    }
+    if (end - ptr >= 4)
+    {
+        hash ^= read32(ptr) * PRIME_1;
+        hash = rotl(hash, 23) * PRIME_2 + PRIME_3;
+        ptr += 4;
+    }
+    for (; ptr != end; ++ptr)
+    {
+        hash ^= static_cast<unsigned char>(*ptr) * PRIME_5;
+        hash = rotl(hash, 11) * PRIME_1;
+    }
+
+    return avalanche(hash);
+}
+
+std::uint64_t Section::fingerprint() const
+{
+    std::uint64_t hash = size();
+    for (auto const& [key, value] : *this)
+    {
+        hash = combine(hash, hash64(key));
+        hash = combine(hash, value.fingerprint());
+    }
+    return hash;
+}
+
+std::uint64_t File::fingerprint() const
+{
+    std::uint64_t hash = size();
+    for (auto const& [name, section] : *this)
+    {
+        hash = combine(hash, hash64(name));
+        hash = combine(hash, section.fingerprint());
+    }
+    return hash;
+}
+
+} // namespace ini
@@ -1,10 +1,355 @@
 #include "inifile/inifile.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
 
-#include "stralgo.h"
+#include "fileio.h"
+#include "inifile/stralgo.h"
+#include "recorder.h"
+
+namespace
+{
+    enum class LineStatus
+    {
+        Line,
+        End,
+        LineTooLong,
+        InputTooLarge,
+    };
+
+    /// Split a string into lines like std::getline() without copying.
+    class LineSplitter
+    {
+      public:
+        /// Lines stay valid after the next call.
+        static constexpr bool stable = true;
+
+        LineSplitter(std::string_view str, ini::Limits const& limits)
+            : rest_(str),
+              max_line_length_(limits.max_line_length),
+              too_large_(str.size() > limits.max_total_bytes)
+        {}
+
+        LineStatus operator()(std::string_view& line)
+        {
+            if (too_large_)
+            {
+                return LineStatus::InputTooLarge;
+            }
+            if (rest_.empty())
+            {
+                return LineStatus::End;
+            }
+
+            // Never look further than the longest line allowed, plus its '\n'.
+            auto window_size = max_line_length_ == ini::Limits::UNLIMITED ? max_line_length_ : max_line_length_ + 1;
+            auto window = rest_.substr(0, window_size);
+            auto pos = window.find('\n');
+            if (pos == std::string_view::npos && window.size() > max_line_length_)
+            {
+                return LineStatus::LineTooLong;
+            }
+
+            line = rest_.substr(0, pos);
+            rest_ = pos == std::string_view::npos ? std::string_view{} : rest_.substr(pos + 1);
+            return LineStatus::Line;
+        }
+
+      private:
+        std::string_view rest_;
+        std::size_t max_line_length_;
+        bool too_large_;
+    };
+
+    /// Read lines from a stream in chunks, without reading past the limits.
+    class LineReader
+    {
+      public:
+        /// Lines are overwritten by the next call.
+        static constexpr bool stable = false;
+
+        LineReader(std::istream& input, ini::Limits const& limits)
+            : input_(input),
+              max_line_length_(limits.max_line_length),
+              max_total_bytes_(limits.max_total_bytes)
+        {}
+
+        LineStatus operator()(std::string_view& line)
+        {
+            while (true)
+            {
+                // Each byte is searched only once, as `scan_` remembers where the last search ended.
+                auto pos = buffer_.find('\n', scan_);
+                scan_ = pos == std::string::npos ? buffer_.size() : pos;
+                if (scan_ - begin_ > max_line_length_)
+                {
+                    return LineStatus::LineTooLong;
+                }
+
+                if (pos != std::string::npos || (eof_ && begin_ != buffer_.size()))
+                {
+                    line = std::string_view(buffer_).substr(begin_, scan_ - begin_);
+                    begin_ = scan_ = std::min(scan_ + 1, buffer_.size());
+                    return LineStatus::Line;
+                }
+                if (eof_)
+                {
+                    return LineStatus::End;
+                }
+                if (!fill())
+                {
+                    return LineStatus::InputTooLarge;
+                }
+            }
+        }
+
+      private:
+        static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+        /// Get the bytes to read to go one past limit, when `used` are used already.
+        static std::size_t past(std::size_t limit, std::size_t used)
+        {
+            return limit == ini::Limits::UNLIMITED ? limit : limit - used + 1;
+        }
+
+        /// Read the next chunk. Return false iff the input is too large.
+        bool fill()
+        {
+            // Drop consumed bytes only once they are the larger part,
+            // so that every byte is moved O(1) times in amortized.
+            if (begin_ > buffer_.size() / 2)
+            {
+                buffer_.erase(0, begin_);
+                scan_ -= begin_;
+                begin_ = 0;
+            }
+
+            // Never read more than one byte past a limit, which is enough to see it is exceeded.
+            // No line break is buffered after begin_, so the bytes from there are all one line.
+            auto request = std::min({CHUNK_SIZE, past(max_line_length_, buffer_.size() - begin_), past(max_total_bytes_, total_)});
+
+            auto size = buffer_.size();
+            buffer_.resize(size + request);
+            input_.read(buffer_.data() + size, static_cast<std::streamsize>(request));
+            auto count = static_cast<std::size_t>(input_.gcount());
+            buffer_.resize(size + count);
+
+            eof_ = count == 0;
+            total_ += count;
+            return total_ <= max_total_bytes_;
+        }
+
+        std::istream& input_;
+        std::size_t max_line_length_;
+        std::size_t max_total_bytes_;
+        std::string buffer_;
+        std::size_t begin_ = 0; // beginning of the next line in buffer_.
+        std::size_t scan_ = 0;  // where to search the next line break.
+        std::size_t total_ = 0;
+        bool eof_ = false;
+    };
+
+    /// Find the position of key in map, like lower_bound().
+    /// Keys are often sorted in the input, so try the one right after `previous` first.
+    template<typename Map>
+    typename Map::iterator find_position(Map& map, typename Map::iterator previous, std::string_view key)
+    {
+        if (previous != map.end() && previous->first < key)
+        {
+            auto next = std::next(previous);
+            if (next == map.end() || key <= next->first)
+            {
+                return next;
+            }
+        }
+        return map.lower_bound(key);
+    }
+
+    /// Bytes File::encode() writes for one section.
+    std::size_t encoded_size(std::string_view name, ini::Section const& section)
+    {
+        // "[name]\n", then "key = value\n" for each key, then "\n".
+        std::size_t size = name.size() + 3 + 1;
+        for (auto const& [key, value] : section)
+        {
+            size += key.size() + 3 + value.as_str().size() + 1;
+        }
+        return size;
+    }
+
+    /// Format sections in [first, last) exactly like File::encode().
+    std::string encode_range(ini::File::const_iterator first, ini::File::const_iterator last, std::size_t size)
+    {
+        std::string result;
+        result.reserve(size);
+        for (; first != last; ++first)
+        {
+            auto const& [name, section] = *first;
+            result.append("[").append(name).append("]\n");
+            for (auto const& [key, value] : section)
+            {
+                result.append(key).append(" = ").append(value.as_str()).append("\n");
+            }
+            result.append("\n");
+        }
+        return result;
+    }
+
+    /// Smallest piece of output worth a thread of its own.
+    constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    /// Encode file into contiguous chunks, formatted on up to `threads` threads.
+    /// Concatenating the chunks gives the output of File::encode().
+    std::vector<std::string> encode_chunks(ini::File const& file, unsigned threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+
+        std::vector<std::size_t> sizes;
+        sizes.reserve(file.size());
+        std::size_t total = 0;
+        for (auto const& [name, section] : file)
+        {
+            sizes.push_back(encoded_size(name, section));
+            total += sizes.back();
+        }
+
+        std::vector<std::string> chunks;
+        auto count = std::min<std::size_t>({threads, total / MIN_CHUNK_SIZE, file.size()});
+        if (count <= 1)
+        {
+            chunks.push_back(encode_range(file.begin(), file.end(), total));
+            return chunks;
+        }
+
+        // Cut at section boundaries so that each chunk holds about total / count bytes.
+        struct Range
+        {
+            ini::File::const_iterator first, last;
+            std::size_t size;
+        };
+        std::vector<Range> ranges;
+        ranges.reserve(count);
+
+        auto first = file.begin();
+        auto it = file.begin();
+        std::size_t done = 0, size = 0;
+        for (std::size_t i = 0; i < sizes.size(); ++i, ++it)
+        {
+            size += sizes[i];
+            if (done + size >= total / count * (ranges.size() + 1) && ranges.size() + 1 < count)
+            {
+                ranges.push_back(Range{first, std::next(it), size});
+                first = std::next(it);
+                done += size;
+                size = 0;
+            }
+        }
+        ranges.push_back(Range{first, file.end(), size});
+
+        // The calling thread takes the last chunk itself.
+        std::vector<std::future<std::string>> futures;
+        futures.reserve(ranges.size() - 1);
+        for (std::size_t i = 0; i + 1 < ranges.size(); ++i)
+        {
+            futures.push_back(std::async(std::launch::async, encode_range, ranges[i].first, ranges[i].last, ranges[i].size));
+        }
+
+        chunks.reserve(ranges.size());
+        auto last = encode_range(ranges.back().first, ranges.back().last, ranges.back().size);
+        for (auto& future : futures)
+        {
+            chunks.push_back(future.get());
+        }
+        chunks.push_back(std::move(last));
+        return chunks;
+    }
+
+    /**
+     * A fixed set of threads running File operations in submission order.
+     * It lives until the end of the program, and finishes all queued tasks before.
+     */
+    class WorkerPool
+    {
+      public:
+        static WorkerPool& instance()
+        {
+            static WorkerPool pool(std::max(2U, std::thread::hardware_concurrency()));
+            return pool;
+        }
+
+        void submit(std::function<void()> task)
+        {
+            {
+                std::lock_guard lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            ready_.notify_one();
+        }
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            ready_.notify_all();
+            for (auto& worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+      private:
+        explicit WorkerPool(unsigned size)
+        {
+            workers_.reserve(size);
+            for (unsigned i = 0; i < size; ++i)
+            {
+                workers_.emplace_back([this] { run(); });
+            }
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                std::unique_lock lock(mutex_);
+                ready_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                {
+                    return;
+                }
+                auto task = std::move(tasks_.front());
+                tasks_.pop_front();
+                lock.unlock();
+
+                task();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::function<void()>> tasks_;
+        bool stop_ = false;
+        std::vector<std::thread> workers_;
+    };
+
+} // anonymous namespace
 
 namespace ini
 {
@@ -23,22 +368,244 @@ bool File::read(std::filesystem::path const& file)
 
 bool File::write(std::filesystem::path const& file) const
 {
-    std::ofstream stream(file);
-    if (!stream.is_open())
+    return write(file, WriteOptions{});
+}
+
+bool File::write(std::filesystem::path const& file, WriteOptions const& options) const
+{
+    auto chunks = encode_chunks(*this, options.threads);
+    std::vector<std::string_view> content(chunks.begin(), chunks.end());
+
+    if (!options.atomic)
     {
-        error_ = "Failed to open file at " + file.string();
+        return io::write_file(file, content, options.sync, error_);
+    }
+
+    // Replace the file a symlink points to, not the symlink itself.
+    auto target = io::resolve_symlinks(file);
+    std::filesystem::path temporary;
+    if (!io::write_temporary(target, content, options.sync, temporary, error_))
+    {
+        return false;
+    }
+    if (!io::replace_file(temporary, target, error_))
+    {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
         return false;
     }
+    return !options.sync || io::sync_directory(io::parent_directory(target), error_);
+}
 
-    encode(stream);
+struct AsyncResult::State
+{
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool done = false;
+    bool result = false;
+    std::exception_ptr error;
+    /// The coroutine waiting for the result, resumed by the worker.
+    std::coroutine_handle<> continuation;
+    /// Resume continuation somewhere else than on the worker.
+    Executor executor;
+};
+
+AsyncResult::AsyncResult(std::function<bool()> operation, Executor executor): state_(std::make_shared<State>())
+{
+    state_->executor = std::move(executor);
+    WorkerPool::instance().submit([state = state_, operation = std::move(operation)] {
+        bool result = false;
+        std::exception_ptr error;
+        try
+        {
+            result = operation();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::coroutine_handle<> continuation;
+        {
+            std::lock_guard lock(state->mutex);
+            state->done = true;
+            state->result = result;
+            state->error = error;
+            continuation = std::exchange(state->continuation, nullptr);
+        }
+        state->ready.notify_all();
+
+        if (!continuation)
+        {
+            return;
+        }
+        if (state->executor)
+        {
+            state->executor(continuation);
+        }
+        else
+        {
+            continuation.resume();
+        }
+    });
+}
+
+AsyncResult::~AsyncResult()
+{
+    if (state_)
+    {
+        std::unique_lock lock(state_->mutex);
+        // The awaiting coroutine is being destroyed while suspended, so it must not be resumed.
+        state_->continuation = nullptr;
+        state_->ready.wait(lock, [this] { return state_->done; });
+    }
+}
+
+bool AsyncResult::get()
+{
+    {
+        std::unique_lock lock(state_->mutex);
+        state_->ready.wait(lock, [this] { return state_->done; });
+    }
+    return await_resume();
+}
+
+bool AsyncResult::await_ready() const
+{
+    std::lock_guard lock(state_->mutex);
+    return state_->done;
+}
+
+bool AsyncResult::await_suspend(std::coroutine_handle<> handle)
+{
+    std::lock_guard lock(state_->mutex);
+    if (state_->done)
+    {
+        // Finished in the meantime, so go on without suspending.
+        return false;
+    }
+    state_->continuation = handle;
     return true;
 }
 
+bool AsyncResult::await_resume()
+{
+    if (state_->error)
+    {
+        std::rethrow_exception(state_->error);
+    }
+    return state_->result;
+}
+
+AsyncResult File::async_read(std::filesystem::path file, Executor executor)
+{
+    return AsyncResult([this, file = std::move(file)] { return read(file); }, std::move(executor));
+}
+
+AsyncResult File::async_write(std::filesystem::path file, Executor executor) const
+{
+    return AsyncResult([this, file = std::move(file)] { return write(file); }, std::move(executor));
+}
+
+void BatchWriter::add(File const& file, std::filesystem::path path)
+{
+    // Two spellings of one target would rename over it twice.
+    std::error_code code;
+    auto identity = std::filesystem::weakly_canonical(path, code);
+    if (code)
+    {
+        identity = path.lexically_normal();
+    }
+
+    auto found = std::ranges::find(pending_, identity, &Pending::identity);
+    if (found != pending_.end())
+    {
+        found->content = file.encode();
+        return;
+    }
+    pending_.push_back(Pending{.path = std::move(path), .identity = std::move(identity), .content = file.encode()});
+}
+
+bool BatchWriter::commit()
+{
+    auto pending = std::move(pending_);
+    pending_.clear();
+
+    std::vector<std::filesystem::path> temporaries;
+    temporaries.reserve(pending.size());
+
+    auto discard = [&temporaries] {
+        std::error_code ignored;
+        for (auto const& temporary : temporaries)
+        {
+            std::filesystem::remove(temporary, ignored);
+        }
+    };
+
+    // Replace the files symlinks point to, not the symlinks themselves.
+    std::vector<std::filesystem::path> targets;
+    targets.reserve(pending.size());
+    for (auto const& [path, identity, content] : pending)
+    {
+        std::string_view data = content;
+        targets.push_back(io::resolve_symlinks(path));
+        if (!io::write_temporary(targets.back(), std::span<std::string_view const>(&data, 1), sync_, temporaries.emplace_back(), error_))
+        {
+            temporaries.pop_back();
+            discard();
+            return false;
+        }
+    }
+
+    std::set<std::filesystem::path> directories;
+    for (std::size_t i = 0; i < pending.size(); ++i)
+    {
+        if (!io::replace_file(temporaries[i], targets[i], error_))
+        {
+            temporaries.erase(temporaries.begin(), temporaries.begin() + static_cast<std::ptrdiff_t>(i));
+            discard();
+            return false;
+        }
+        directories.insert(io::parent_directory(targets[i]));
+    }
+
+    if (sync_)
+    {
+        for (auto const& directory : directories)
+        {
+            if (!io::sync_directory(directory, error_))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::string_view Diagnostic::message() const
+{
+    switch (kind)
+    {
+        case Kind::MissingSection:
+            return "Expected a section name";
+
+        case Kind::InvalidLine:
+            return "Invalid line";
+
+        case Kind::LimitExceeded:
+            return "Limit exceeded";
+    }
+    return "Unknown error";
+}
+
 bool File::decode(std::string_view str)
 {
-    std::stringstream stream;
-    stream << str;
-    return decode(stream);
+    return decode_lines(LineSplitter(str, limits_), nullptr);
+}
+
+bool File::decode(std::string_view str, std::vector<Diagnostic>& diagnostics)
+{
+    return decode_lines(LineSplitter(str, limits_), &diagnostics);
 }
 
 std::string File::encode() const
@@ -69,44 +636,175 @@ void File::encode(std::ostream& output) const
 
 bool File::decode(std::istream& input)
 {
-    std::string buffer;
-    std::string current_section;
-    int line = 0; // record line number.
+    return decode_lines(LineReader(input, limits_), nullptr);
+}
+
+bool File::decode(std::istream& input, std::vector<Diagnostic>& diagnostics)
+{
+    return decode_lines(LineReader(input, limits_), &diagnostics);
+}
+
+template<typename NextLine>
+bool File::decode_lines(NextLine&& next_line, std::vector<Diagnostic>* diagnostics)
+{
+    std::string_view buffer;
+    // name of the last section header, copied only if the line will be overwritten.
+    std::conditional_t<std::remove_reference_t<NextLine>::stable, std::string_view, std::string> section_name;
+    auto current_section = end();     // end() until the first key of the section.
+    auto previous_section = end();    // the last section looked up.
+    Section::iterator previous_key{}; // valid iff current_section is not end().
+    int line = 0;                     // record line number.
+    std::size_t offset = 0;           // record byte offset of the line.
+    std::size_t sections = 0;         // sections created.
+    std::size_t keys = 0;             // keys created.
+    bool success = true;
+    stats::Recorder recorder;
+
+    // Record an error at the first non-blank char of the line.
+    // Return true iff decoding should go on.
+    auto report = [&](Diagnostic::Kind kind) {
+        auto column = buffer.find_first_not_of(" \t\r\n");
+        column = column == std::string_view::npos ? 0 : column;
+
+        if (success)
+        {
+            error_ = "Syntax error at line " + std::to_string(line);
+            if (kind == Diagnostic::Kind::MissingSection)
+            {
+                error_ += ": Expected a section name";
+            }
+        }
+        success = false;
 
-    while (std::getline(input, buffer))
+        if (diagnostics == nullptr)
+        {
+            return false;
+        }
+        diagnostics->push_back(Diagnostic{
+            .kind   = kind,
+            .line   = line,
+            .column = static_cast<int>(column) + 1,
+            .offset = offset + column,
+        });
+        return true;
+    };
+
+    // Record an exceeded limit and stop.
+    auto exceed = [&](std::string_view what, std::size_t limit) {
+        error_ = fmt::format("Limit exceeded at line {}: {} is larger than {}", line, what, limit);
+        if (diagnostics != nullptr)
+        {
+            diagnostics->push_back(Diagnostic{
+                .kind   = Diagnostic::Kind::LimitExceeded,
+                .line   = line,
+                .column = 1,
+                .offset = offset,
+            });
+        }
+        recorder.finish(false);
+        return false;
+    };
+
+    for (auto status = next_line(buffer); status != LineStatus::End; offset += buffer.size() + 1, status = next_line(buffer))
     {
         ++line;
+        switch (status)
+        {
+            case LineStatus::LineTooLong:
+                return exceed("line length", limits_.max_line_length);
+
+            case LineStatus::InputTooLarge:
+                return exceed("total input size", limits_.max_total_bytes);
+
+            default:
+                break;
+        }
+        recorder.line(buffer.size());
 
         auto processed_str = str::erase_comments(buffer);
 
         // Process section.
+        // It is looked up lazily, so that empty sections are never created.
         if (auto name = str::extract_section_name(processed_str); !name.empty())
         {
-            current_section = name;
+            recorder.tokenized();
+            section_name = name;
+            current_section = end();
             continue;
         }
 
         // Process key-value.
         if (auto [key, value] = str::extract_key_value(processed_str); !key.empty())
         {
-            if (current_section.empty())
+            recorder.tokenized();
+            if (key.size() > limits_.max_key_size)
             {
-                error_ = "Syntax error at line " + std::to_string(line) + ": Expected a section name";
-                return false;
+                return exceed("key size", limits_.max_key_size);
+            }
+            if (value.size() > limits_.max_value_size)
+            {
+                return exceed("value size", limits_.max_value_size);
+            }
+            if (section_name.empty())
+            {
+                if (!report(Diagnostic::Kind::MissingSection))
+                {
+                    recorder.finish(false);
+                    return false;
+                }
+                continue;
+            }
+
+            if (current_section == end())
+            {
+                current_section = find_position(*this, previous_section, section_name);
+                if (current_section == end() || current_section->first != section_name)
+                {
+                    if (++sections > limits_.max_sections)
+                    {
+                        return exceed("section count", limits_.max_sections);
+                    }
+                    current_section = emplace_hint(current_section, section_name, Section{});
+                    recorder.section_created(section_name);
+                }
+                previous_section = current_section;
+                previous_key = current_section->second.end();
             }
 
-            (*this)[current_section][std::string(key)] = value;
+            auto& section = current_section->second;
+            auto field = find_position(section, previous_key, key);
+            if (field != section.end() && field->first == key)
+            {
+                field->second = value;
+            }
+            else
+            {
+                if (++keys > limits_.max_keys)
+                {
+                    return exceed("key count", limits_.max_keys);
+                }
+                field = section.emplace_hint(field, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(value));
+                recorder.key_created(key);
+            }
+            previous_key = field;
+            recorder.value_assigned(value);
+            recorder.inserted();
             continue;
         }
 
         // Process error line.
+        recorder.tokenized();
         if (!str::is_empty_line(processed_str))
         {
-            error_ = "Syntax error at line " + std::to_string(line);
-            return false;
+            if (!report(Diagnostic::Kind::InvalidLine))
+            {
+                recorder.finish(false);
+                return false;
+            }
         }
     }
-    return true;
+    recorder.finish(success);
+    return success;
 }
 
 } // namespace ini
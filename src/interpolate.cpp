@@ -0,0 +1,244 @@
+#include "inifile/interpolate.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "fmt/format.h"
+
+namespace ini
+{
+
+Interpolator::Interpolator(File const& file, InterpolationLimits const& limits): file_(file), limits_(limits)
+{
+    for (auto const& [section_name, section] : file_)
+    {
+        for (auto const& [key, value] : section)
+        {
+            link(node(section_name, key));
+        }
+    }
+}
+
+Field const& Interpolator::get(std::string_view section, std::string_view key)
+{
+    return expand(node(section, key));
+}
+
+void Interpolator::invalidate(std::string_view section, std::string_view key)
+{
+    auto& target = node(section, key);
+    drop(target);
+    unlink(target);
+    link(target);
+}
+
+Interpolator::Node& Interpolator::node(std::string_view section, std::string_view key)
+{
+    auto section_it = nodes_.find(section);
+    if (section_it == nodes_.end())
+    {
+        section_it = nodes_.emplace(std::string(section), std::map<std::string, Node, std::less<>>{}).first;
+    }
+
+    auto& keys = section_it->second;
+    auto key_it = keys.find(key);
+    if (key_it == keys.end())
+    {
+        key_it = keys.emplace(std::string(key), Node{}).first;
+        key_it->second.section = section_it->first;
+        key_it->second.key = key_it->first;
+    }
+    return key_it->second;
+}
+
+void Interpolator::link(Node& target)
+{
+    target.source = nullptr;
+    if (auto section = file_.find(target.section); section != file_.end())
+    {
+        if (auto field = section->second.find(target.key); field != section->second.end())
+        {
+            target.source = &field->second;
+        }
+    }
+    if (target.source == nullptr)
+    {
+        return;
+    }
+
+    std::string_view rest = target.source->as_str();
+    while (!rest.empty())
+    {
+        auto begin = rest.find("${");
+        auto end = begin == std::string_view::npos ? begin : rest.find('}', begin + 2);
+        if (end == std::string_view::npos)
+        {
+            target.segments.push_back(Segment{.text = rest});
+            break;
+        }
+
+        if (begin != 0)
+        {
+            target.segments.push_back(Segment{.text = rest.substr(0, begin)});
+        }
+
+        auto name = rest.substr(begin + 2, end - begin - 2);
+        // Section names like "backend:eu" contain ':' too, so the key follows the last one.
+        if (auto colon = name.rfind(':'); colon != std::string_view::npos)
+        {
+            auto& reference = node(name.substr(0, colon), name.substr(colon + 1));
+            reference.dependents.push_back(&target);
+            target.segments.push_back(Segment{.text = name, .reference = &reference});
+        }
+        else
+        {
+            target.segments.push_back(Segment{.text = name, .environment = true});
+        }
+        rest.remove_prefix(end + 1);
+    }
+}
+
+void Interpolator::unlink(Node& target)
+{
+    for (auto const& segment : target.segments)
+    {
+        if (segment.reference != nullptr)
+        {
+            auto& dependents = segment.reference->dependents;
+            dependents.erase(std::find(dependents.begin(), dependents.end(), &target));
+        }
+    }
+    target.segments.clear();
+}
+
+Field const& Interpolator::expand(Node& target)
+{
+    // Depth-first on an explicit stack: a node is marked visiting when its references are pushed,
+    // and expanded when it is reached again with all of them done.
+    std::vector<Node*> stack{&target};
+    try
+    {
+        while (!stack.empty())
+        {
+            auto& current = *stack.back();
+            if (current.result != nullptr)
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            if (current.source == nullptr)
+            {
+                throw InterpolationError(fmt::format("Unknown key {} in section {}.", current.key, current.section));
+            }
+
+            bool has_reference = std::any_of(current.segments.begin(), current.segments.end(), [](Segment const& segment) {
+                return segment.reference != nullptr || segment.environment;
+            });
+            if (!has_reference)
+            {
+                current.result = current.source;
+                stack.pop_back();
+                continue;
+            }
+
+            if (current.visiting)
+            {
+                expand_segments(current);
+                current.visiting = false;
+                stack.pop_back();
+                continue;
+            }
+
+            current.visiting = true;
+            for (auto const& segment : current.segments)
+            {
+                if (segment.reference == nullptr || segment.reference->result != nullptr)
+                {
+                    continue;
+                }
+                if (segment.reference->visiting)
+                {
+                    throw InterpolationError(fmt::format("Cyclic reference at key {} in section {}.", segment.reference->key, segment.reference->section));
+                }
+                stack.push_back(segment.reference);
+            }
+        }
+    }
+    catch (...)
+    {
+        for (auto* node : stack)
+        {
+            node->visiting = false;
+        }
+        throw;
+    }
+    return *target.result;
+}
+
+void Interpolator::expand_segments(Node& target)
+{
+    auto append = [&](std::string& value, std::string_view text) {
+        if (text.size() > limits_.max_value_size - value.size())
+        {
+            throw InterpolationError(fmt::format("Expanded value of key {} in section {} is larger than {} bytes.",
+                                                 target.key, target.section, limits_.max_value_size));
+        }
+        value += text;
+    };
+
+    std::string value;
+    for (auto const& segment : target.segments)
+    {
+        if (segment.reference != nullptr)
+        {
+            append(value, segment.reference->result->as_str());
+        }
+        else if (segment.environment)
+        {
+            char const* env = std::getenv(std::string(segment.text).c_str());
+            if (env == nullptr)
+            {
+                throw InterpolationError(fmt::format("Unknown environment variable {}.", segment.text));
+            }
+            append(value, env);
+        }
+        else
+        {
+            append(value, segment.text);
+        }
+    }
+
+    if (value.size() > limits_.max_total_size - total_size_)
+    {
+        throw InterpolationError(fmt::format("Expanded values are larger than {} bytes in total.", limits_.max_total_size));
+    }
+    total_size_ += value.size();
+
+    target.expanded.emplace(std::move(value));
+    target.result = &*target.expanded;
+}
+
+void Interpolator::drop(Node& target)
+{
+    std::vector<Node*> stack{&target};
+    while (!stack.empty())
+    {
+        auto& current = *stack.back();
+        stack.pop_back();
+        if (current.result == nullptr)
+        {
+            continue;
+        }
+
+        if (current.expanded)
+        {
+            total_size_ -= current.expanded->as_str().size();
+        }
+        current.result = nullptr;
+        current.expanded.reset();
+        stack.insert(stack.end(), current.dependents.begin(), current.dependents.end());
+    }
+}
+
+} // namespace ini
@@ -0,0 +1,66 @@
+#include "inifile/inifile.h"
+
+#include <utility>
+
+namespace
+{
+    /// Color and three links in front of each value of a std::map node.
+    constexpr std::size_t NODE_HEADER_SIZE = 4 * sizeof(void*);
+
+    template<typename Map>
+    constexpr std::size_t node_size()
+    {
+        constexpr auto align = alignof(typename Map::value_type);
+        constexpr auto header = (NODE_HEADER_SIZE + align - 1) / align * align;
+        return header + sizeof(typename Map::value_type);
+    }
+
+    /// Account the heap buffer of str, if it is not stored inline.
+    void add_string(ini::MemoryUsage& usage, std::string const& str)
+    {
+        static std::size_t const inline_capacity = std::string().capacity();
+        if (str.capacity() > inline_capacity)
+        {
+            usage.strings += str.size() + 1;
+            usage.slack += str.capacity() - str.size();
+        }
+    }
+} // anonymous namespace
+
+namespace ini
+{
+
+MemoryUsage File::memory_usage() const
+{
+    MemoryUsage usage;
+    usage.nodes += size() * node_size<File>();
+    for (auto const& [name, section] : *this)
+    {
+        add_string(usage, name);
+        usage.nodes += section.size() * node_size<Section>();
+        for (auto const& [key, value] : section)
+        {
+            add_string(usage, key);
+            add_string(usage, value.as_str());
+        }
+    }
+    return usage;
+}
+
+void File::compact()
+{
+    // Building from views allocates each string with its exact size,
+    // and inserting at the end in order keeps neighbouring nodes close in memory.
+    std::map<std::string, Section, std::less<>> compacted;
+    for (auto const& [name, section] : *this)
+    {
+        auto& target = compacted.emplace_hint(compacted.end(), std::string_view(name), Section{})->second;
+        for (auto const& [key, value] : section)
+        {
+            target.emplace_hint(target.end(), std::string_view(key), std::string_view(value.as_str()));
+        }
+    }
+    std::map<std::string, Section, std::less<>>::swap(compacted);
+}
+
+} // namespace ini
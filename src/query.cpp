@@ -0,0 +1,79 @@
+#include "inifile/inifile.h"
+
+#include "inifile/stralgo.h"
+
+namespace
+{
+    /// A key comparing greater than every string starting with prefix,
+    /// and less than every other string greater than prefix.
+    struct PrefixEnd
+    {
+        std::string_view prefix;
+
+        friend bool operator<(PrefixEnd const& end, std::string const& str)
+        {
+            return !str.starts_with(end.prefix) && end.prefix < str;
+        }
+
+        friend bool operator<(std::string const& str, PrefixEnd const& end)
+        {
+            return str.starts_with(end.prefix) || str < end.prefix;
+        }
+    };
+
+    template<typename Map>
+    auto prefix_range(Map& map, std::string_view prefix)
+    {
+        return std::ranges::subrange(map.lower_bound(prefix), map.upper_bound(PrefixEnd{prefix}));
+    }
+
+    template<typename Map>
+    std::vector<typename Map::const_iterator> glob_range(Map const& map, std::string_view pattern)
+    {
+        std::vector<typename Map::const_iterator> result;
+        auto range = prefix_range(map, ini::str::glob_prefix(pattern));
+        for (auto it = range.begin(); it != range.end(); ++it)
+        {
+            if (ini::str::glob_match(pattern, it->first))
+            {
+                result.push_back(it);
+            }
+        }
+        return result;
+    }
+} // anonymous namespace
+
+namespace ini
+{
+
+std::ranges::subrange<Section::iterator> Section::keys_with_prefix(std::string_view prefix)
+{
+    return prefix_range(*this, prefix);
+}
+
+std::ranges::subrange<Section::const_iterator> Section::keys_with_prefix(std::string_view prefix) const
+{
+    return prefix_range(*this, prefix);
+}
+
+std::vector<Section::const_iterator> Section::keys_matching(std::string_view pattern) const
+{
+    return glob_range(*this, pattern);
+}
+
+std::ranges::subrange<File::iterator> File::sections_with_prefix(std::string_view prefix)
+{
+    return prefix_range(*this, prefix);
+}
+
+std::ranges::subrange<File::const_iterator> File::sections_with_prefix(std::string_view prefix) const
+{
+    return prefix_range(*this, prefix);
+}
+
+std::vector<File::const_iterator> File::sections_matching(std::string_view pattern) const
+{
+    return glob_range(*this, pattern);
+}
+
+} // namespace ini
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "inifile/stats.h"
+
+namespace ini::stats
+{
+
+#ifdef INI_ENABLE_STATS
+
+/// Collect statistics of one File::decode() call.
+class Recorder
+{
+  public:
+    Recorder(): last_(Clock::now()) {}
+
+    /// A line of `size` bytes has been read.
+    void line(std::size_t size)
+    {
+        stats_.bytes += size + 1;
+        ++stats_.lines;
+    }
+
+    /// A section has been inserted.
+    void section_created(std::string_view name)
+    {
+        ++stats_.sections;
+        stats_.allocations += 1 + allocates(name);
+    }
+
+    /// A key has been inserted.
+    void key_created(std::string_view key)
+    {
+        ++stats_.keys;
+        stats_.allocations += 1 + allocates(key);
+    }
+
+    /// A value has been stored.
+    void value_assigned(std::string_view value) { stats_.allocations += allocates(value); }
+
+    /// Charge the time since the last mark to tokenizing.
+    void tokenized() { lap(stats_.tokenize_time); }
+
+    /// Charge the time since the last mark to map insertion.
+    void inserted() { lap(stats_.insert_time); }
+
+    /// Publish the statistics.
+    void finish(bool success)
+    {
+        stats_.failures += success ? 0 : 1;
+        record_parse(stats_);
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    static unsigned allocates(std::string_view str) { return str.size() > std::string{}.capacity() ? 1 : 0; }
+
+    void lap(std::chrono::nanoseconds& bucket)
+    {
+        auto now = Clock::now();
+        bucket += now - last_;
+        last_ = now;
+    }
+
+    ParseStats stats_;
+    Clock::time_point last_;
+};
+
+#else
+
+/// Instrumentation is disabled, so every hook does nothing.
+class Recorder
+{
+  public:
+    void line(std::size_t /*size*/) {}
+    void section_created(std::string_view /*name*/) {}
+    void key_created(std::string_view /*key*/) {}
+    void value_assigned(std::string_view /*value*/) {}
+    void tokenized() {}
+    void inserted() {}
+    void finish(bool /*success*/) {}
+};
+
+#endif
+
+} // namespace ini::stats
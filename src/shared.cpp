@@ -0,0 +1,538 @@
+#include "inifile/shared.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fmt/format.h"
+
+namespace
+{
+    constexpr std::uint64_t MAGIC = 0x31454C4946494E49ULL; // "INIFILE1"
+
+    /// Layout: SegmentHeader, then two slots of `slot_size` bytes.
+    struct SegmentHeader
+    {
+        std::uint64_t magic;
+        std::uint64_t generation;
+        std::uint64_t slot_size;
+        /// Bits of SegmentFlag.
+        std::uint64_t flags;
+    };
+
+    enum SegmentFlag : std::uint64_t
+    {
+        /// The publisher has replaced this segment by a new one.
+        SUPERSEDED = 1,
+    };
+
+    /// Layout of a slot: SlotHeader, SectionRecord[], KeyRecord[], then string bytes.
+    /// All offsets are relative to the slot.
+    struct SlotHeader
+    {
+        std::uint64_t seq;
+        std::uint64_t used;
+        std::uint32_t section_count;
+        std::uint32_t key_count;
+    };
+
+    struct SectionRecord
+    {
+        std::uint32_t name_offset;
+        std::uint32_t name_size;
+        std::uint32_t first_key;
+        std::uint32_t key_count;
+    };
+
+    struct KeyRecord
+    {
+        std::uint32_t key_offset;
+        std::uint32_t key_size;
+        std::uint32_t value_offset;
+        std::uint32_t value_size;
+    };
+
+    std::atomic_ref<std::uint64_t> atomic(std::uint64_t const& value)
+    {
+        // Only loads are done through a const reference, which is fine on read-only memory.
+        return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t&>(value));
+    }
+
+    SegmentHeader const& segment(std::byte const* memory)
+    {
+        return *reinterpret_cast<SegmentHeader const*>(memory);
+    }
+
+    std::byte const* slot(std::byte const* memory, std::uint64_t index)
+    {
+        return memory + sizeof(SegmentHeader) + index * segment(memory).slot_size;
+    }
+
+    /// Tell subscribers still attached to the segment of fd that it is being replaced.
+    void mark_superseded(int fd, std::size_t size)
+    {
+        if (size < sizeof(SegmentHeader))
+        {
+            return;
+        }
+        void* memory = ::mmap(nullptr, sizeof(SegmentHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED)
+        {
+            return;
+        }
+        auto& header = *static_cast<SegmentHeader*>(memory);
+        atomic(header.flags).fetch_or(SUPERSEDED, std::memory_order_release);
+        ::munmap(memory, sizeof(SegmentHeader));
+    }
+
+    /**
+     * Bounds-checked access to a slot.
+     * A slot may be overwritten while it is read, so nothing in it is trusted.
+     */
+    class SlotReader
+    {
+      public:
+        SlotReader(std::byte const* data, std::size_t capacity): data_(data)
+        {
+            std::memcpy(&header_, data, sizeof(header_));
+            auto records = sizeof(SlotHeader) + header_.section_count * sizeof(SectionRecord) + header_.key_count * sizeof(KeyRecord);
+            valid_ = header_.used <= capacity && records <= header_.used;
+        }
+
+        [[nodiscard]]
+        bool valid() const { return valid_; }
+
+        [[nodiscard]]
+        std::byte const* data() const { return data_; }
+
+        [[nodiscard]]
+        std::uint64_t used() const { return header_.used; }
+
+        [[nodiscard]]
+        std::uint32_t section_count() const { return header_.section_count; }
+
+        [[nodiscard]]
+        SectionRecord section(std::uint32_t index) const
+        {
+            SectionRecord record{};
+            std::memcpy(&record, data_ + sizeof(SlotHeader) + index * sizeof(SectionRecord), sizeof(record));
+            if (record.first_key > header_.key_count || record.key_count > header_.key_count - record.first_key)
+            {
+                valid_ = false;
+                record.key_count = 0;
+            }
+            return record;
+        }
+
+        [[nodiscard]]
+        KeyRecord key(std::uint32_t index) const
+        {
+            KeyRecord record{};
+            std::memcpy(&record, data_ + sizeof(SlotHeader) + header_.section_count * sizeof(SectionRecord) + index * sizeof(KeyRecord), sizeof(record));
+            return record;
+        }
+
+        /// Get a string in the slot, or an empty one if it is out of bounds.
+        [[nodiscard]]
+        std::string_view string(std::uint32_t offset, std::uint32_t size) const
+        {
+            if (std::uint64_t{offset} + size > header_.used)
+            {
+                valid_ = false;
+                return std::string_view{};
+            }
+            return std::string_view(reinterpret_cast<char const*>(data_ + offset), size);
+        }
+
+      private:
+        std::byte const* data_;
+        SlotHeader header_{};
+        mutable bool valid_;
+    };
+
+    /// Find the index of the first record whose name is not less than name.
+    template<typename GetName>
+    std::uint32_t lower_bound(std::uint32_t begin, std::uint32_t end, std::string_view name, GetName get_name)
+    {
+        while (begin < end)
+        {
+            auto middle = begin + (end - begin) / 2;
+            if (get_name(middle) < name)
+            {
+                begin = middle + 1;
+            }
+            else
+            {
+                end = middle;
+            }
+        }
+        return begin;
+    }
+
+    /// Run `read(SlotReader const&)` on the current version until no publish interleaves with it.
+    /// Return false iff nothing is published yet or the segment is corrupted.
+    template<typename Read>
+    bool read_consistent(std::byte const* memory, Read read)
+    {
+        auto const& header = segment(memory);
+        while (true)
+        {
+            auto generation = atomic(header.generation).load(std::memory_order_acquire);
+            if (generation == 0)
+            {
+                return false;
+            }
+
+            auto const* data = slot(memory, generation % 2);
+            auto const& seq = reinterpret_cast<SlotHeader const*>(data)->seq;
+            auto before = atomic(seq).load(std::memory_order_acquire);
+            if (before % 2 != 0)
+            {
+                continue;
+            }
+
+            SlotReader reader(data, header.slot_size);
+            bool valid = reader.valid() && read(reader);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (atomic(seq).load(std::memory_order_relaxed) == before)
+            {
+                return valid;
+            }
+        }
+    }
+} // anonymous namespace
+
+namespace ini
+{
+
+SharedPublisher::~SharedPublisher()
+{
+    close();
+}
+
+bool SharedPublisher::open(std::string const& name, std::size_t capacity, unsigned mode)
+{
+    close();
+
+    auto slot_size = (sizeof(SlotHeader) + capacity + 7) / 8 * 8;
+    if (slot_size > std::numeric_limits<std::uint32_t>::max())
+    {
+        error_ = fmt::format("Capacity {} is too large for a shared segment", capacity);
+        return false;
+    }
+    auto size = sizeof(SegmentHeader) + 2 * slot_size;
+
+    auto permissions = static_cast<mode_t>(mode);
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, permissions);
+    if (fd < 0)
+    {
+        error_ = fmt::format("Failed to open shared segment {}: {}", name, std::strerror(errno));
+        return false;
+    }
+
+    // Shrinking a segment would crash attached subscribers,
+    // so a segment of another size is replaced by a new one instead.
+    struct stat info{};
+    if (::fstat(fd, &info) == 0 && info.st_size != 0 && static_cast<std::size_t>(info.st_size) != size)
+    {
+        mark_superseded(fd, static_cast<std::size_t>(info.st_size));
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, permissions);
+        if (fd < 0)
+        {
+            error_ = fmt::format("Failed to open shared segment {}: {}", name, std::strerror(errno));
+            return false;
+        }
+    }
+
+    // shm_open() applies the umask, and leaves the mode of an existing segment alone.
+    if (::fchmod(fd, permissions) != 0)
+    {
+        error_ = fmt::format("Failed to change mode of shared segment {}: {}", name, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        error_ = fmt::format("Failed to resize shared segment {}: {}", name, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        error_ = fmt::format("Failed to map shared segment {}: {}", name, std::strerror(errno));
+        return false;
+    }
+
+    memory_ = static_cast<std::byte*>(memory);
+    size_ = size;
+
+    // A segment of the same size is reused, and its subscribers see the next generation.
+    auto& header = *reinterpret_cast<SegmentHeader*>(memory_);
+    header.slot_size = slot_size;
+    atomic(header.magic).store(MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool SharedPublisher::publish(File const& file)
+{
+    if (memory_ == nullptr)
+    {
+        error_ = "Shared segment is not open";
+        return false;
+    }
+
+    auto& header = *reinterpret_cast<SegmentHeader*>(memory_);
+
+    // Measure the document.
+    std::size_t key_count = 0;
+    std::size_t string_size = 0;
+    for (auto const& [name, section] : file)
+    {
+        key_count += section.size();
+        string_size += name.size();
+        for (auto const& [key, value] : section)
+        {
+            string_size += key.size() + value.as_str().size();
+        }
+    }
+    auto records = sizeof(SlotHeader) + file.size() * sizeof(SectionRecord) + key_count * sizeof(KeyRecord);
+    if (records + string_size > header.slot_size)
+    {
+        error_ = fmt::format("Document of {} bytes exceeds the shared segment capacity of {} bytes", records + string_size, header.slot_size - sizeof(SlotHeader));
+        return false;
+    }
+
+    auto generation = header.generation;
+    auto* data = const_cast<std::byte*>(slot(memory_, (generation + 1) % 2));
+    auto& slot_header = *reinterpret_cast<SlotHeader*>(data);
+
+    // A publisher that crashed in the middle of a publish leaves seq odd.
+    // Round it up to even, or readers would wait for the slot forever.
+    auto seq = (slot_header.seq + 1) & ~std::uint64_t{1};
+    atomic(slot_header.seq).store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto* section_record = data + sizeof(SlotHeader);
+    auto* key_record = section_record + file.size() * sizeof(SectionRecord);
+    auto string_offset = static_cast<std::uint32_t>(records);
+
+    auto put_string = [&](std::string_view str) {
+        std::memcpy(data + string_offset, str.data(), str.size());
+        auto offset = string_offset;
+        string_offset += static_cast<std::uint32_t>(str.size());
+        return offset;
+    };
+
+    std::uint32_t key_index = 0;
+    for (auto const& [name, section] : file)
+    {
+        SectionRecord record{
+            .name_offset = put_string(name),
+            .name_size   = static_cast<std::uint32_t>(name.size()),
+            .first_key   = key_index,
+            .key_count   = static_cast<std::uint32_t>(section.size()),
+        };
+        std::memcpy(section_record, &record, sizeof(record));
+        section_record += sizeof(record);
+
+        for (auto const& [key, value] : section)
+        {
+            KeyRecord key_entry{
+                .key_offset   = put_string(key),
+                .key_size     = static_cast<std::uint32_t>(key.size()),
+                .value_offset = put_string(value.as_str()),
+                .value_size   = static_cast<std::uint32_t>(value.as_str().size()),
+            };
+            std::memcpy(key_record, &key_entry, sizeof(key_entry));
+            key_record += sizeof(key_entry);
+            ++key_index;
+        }
+    }
+
+    slot_header.used = string_offset;
+    slot_header.section_count = static_cast<std::uint32_t>(file.size());
+    slot_header.key_count = static_cast<std::uint32_t>(key_count);
+
+    atomic(slot_header.seq).store(seq + 2, std::memory_order_release);
+    atomic(header.generation).store(generation + 1, std::memory_order_release);
+    return true;
+}
+
+bool SharedPublisher::remove(std::string const& name)
+{
+    return ::shm_unlink(name.c_str()) == 0;
+}
+
+void SharedPublisher::close()
+{
+    if (memory_ != nullptr)
+    {
+        ::munmap(memory_, size_);
+        memory_ = nullptr;
+    }
+}
+
+SharedSubscriber::~SharedSubscriber()
+{
+    close();
+}
+
+bool SharedSubscriber::open(std::string const& name)
+{
+    close();
+
+    int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        error_ = fmt::format("Failed to open shared segment {}: {}", name, std::strerror(errno));
+        return false;
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0)
+    {
+        error_ = fmt::format("Failed to stat shared segment {}: {}", name, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    auto size = static_cast<std::size_t>(info.st_size);
+
+    if (size < sizeof(SegmentHeader))
+    {
+        error_ = fmt::format("Shared segment {} is not initialized", name);
+        ::close(fd);
+        return false;
+    }
+
+    void* memory = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        error_ = fmt::format("Failed to map shared segment {}: {}", name, std::strerror(errno));
+        return false;
+    }
+
+    memory_ = static_cast<std::byte const*>(memory);
+    size_ = size;
+
+    auto const& header = segment(memory_);
+    if (atomic(header.magic).load(std::memory_order_acquire) != MAGIC
+        || sizeof(SegmentHeader) + 2 * header.slot_size != size_)
+    {
+        error_ = fmt::format("Shared segment {} has an unknown layout", name);
+        close();
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t SharedSubscriber::generation() const
+{
+    return memory_ == nullptr ? 0 : atomic(segment(memory_).generation).load(std::memory_order_acquire);
+}
+
+bool SharedSubscriber::superseded() const
+{
+    return memory_ != nullptr && (atomic(segment(memory_).flags).load(std::memory_order_acquire) & SUPERSEDED) != 0;
+}
+
+std::optional<std::string> SharedSubscriber::find(std::string_view section, std::string_view key) const
+{
+    if (memory_ == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> result;
+    read_consistent(memory_, [&](SlotReader const& reader) {
+        result.reset();
+
+        auto section_index = lower_bound(0, reader.section_count(), section, [&](std::uint32_t index) {
+            auto record = reader.section(index);
+            return reader.string(record.name_offset, record.name_size);
+        });
+        if (section_index == reader.section_count())
+        {
+            return reader.valid();
+        }
+        auto record = reader.section(section_index);
+        if (reader.string(record.name_offset, record.name_size) != section)
+        {
+            return reader.valid();
+        }
+
+        auto end = record.first_key + record.key_count;
+        auto key_index = lower_bound(record.first_key, end, key, [&](std::uint32_t index) {
+            auto entry = reader.key(index);
+            return reader.string(entry.key_offset, entry.key_size);
+        });
+        if (key_index != end)
+        {
+            auto entry = reader.key(key_index);
+            if (reader.string(entry.key_offset, entry.key_size) == key)
+            {
+                result.emplace(reader.string(entry.value_offset, entry.value_size));
+            }
+        }
+        return reader.valid();
+    });
+    return result;
+}
+
+bool SharedSubscriber::load(File& file) const
+{
+    if (memory_ == nullptr)
+    {
+        return false;
+    }
+
+    // Copy the slot out first, then decode the copy without any race.
+    std::vector<std::byte> copy;
+    bool published = read_consistent(memory_, [&](SlotReader const& reader) {
+        copy.assign(reader.data(), reader.data() + reader.used());
+        return true;
+    });
+    if (!published)
+    {
+        return false;
+    }
+
+    SlotReader reader(copy.data(), copy.size());
+    file.clear();
+    for (std::uint32_t i = 0; i < reader.section_count(); ++i)
+    {
+        auto record = reader.section(i);
+        auto& section = file.emplace_hint(file.end(), reader.string(record.name_offset, record.name_size), Section{})->second;
+        for (auto index = record.first_key; index < record.first_key + record.key_count; ++index)
+        {
+            auto entry = reader.key(index);
+            section.emplace_hint(section.end(), reader.string(entry.key_offset, entry.key_size), reader.string(entry.value_offset, entry.value_size));
+        }
+    }
+    return reader.valid();
+}
+
+void SharedSubscriber::close()
+{
+    if (memory_ != nullptr)
+    {
+        ::munmap(const_cast<std::byte*>(memory_), size_);
+        memory_ = nullptr;
+    }
+}
+
+} // namespace ini
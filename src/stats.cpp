@@ -0,0 +1,83 @@
+#include "inifile/stats.h"
+
+#include <mutex>
+#include <utility>
+
+namespace
+{
+    struct Registry
+    {
+        std::mutex mutex;
+        ini::stats::Snapshot snapshot;
+        std::function<void(ini::stats::ParseStats const&)> callback;
+    };
+
+    Registry& registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+} // anonymous namespace
+
+namespace ini::stats
+{
+
+ParseStats& ParseStats::operator+=(ParseStats const& other)
+{
+    bytes         += other.bytes;
+    lines         += other.lines;
+    sections      += other.sections;
+    keys          += other.keys;
+    allocations   += other.allocations;
+    failures      += other.failures;
+    tokenize_time += other.tokenize_time;
+    insert_time   += other.insert_time;
+    return *this;
+}
+
+Snapshot snapshot()
+{
+    auto& instance = registry();
+    std::lock_guard lock(instance.mutex);
+    return instance.snapshot;
+}
+
+void reset()
+{
+    auto& instance = registry();
+    std::lock_guard lock(instance.mutex);
+    instance.snapshot = Snapshot{};
+}
+
+void set_callback(std::function<void(ParseStats const&)> callback)
+{
+    auto& instance = registry();
+    std::lock_guard lock(instance.mutex);
+    instance.callback = std::move(callback);
+}
+
+void record_parse(ParseStats const& stats)
+{
+    auto& instance = registry();
+    std::function<void(ParseStats const&)> callback;
+    {
+        std::lock_guard lock(instance.mutex);
+        instance.snapshot.parse += stats;
+        ++instance.snapshot.decodes;
+        callback = instance.callback;
+    }
+
+    if (callback)
+    {
+        callback(stats);
+    }
+}
+
+void record_conversion_failure(std::type_info const& type)
+{
+    auto& instance = registry();
+    std::lock_guard lock(instance.mutex);
+    ++instance.snapshot.conversion_failures[std::type_index(type)];
+}
+
+} // namespace ini::stats
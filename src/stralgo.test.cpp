@@ -1,4 +1,4 @@
-#include "stralgo.h"
+#include "inifile/stralgo.h"
 
 #include "gtest/gtest.h"
 
@@ -101,3 +101,31 @@ TEST(EraseComments, NoComments)
     EXPECT_EQ(str::erase_comments("I'm Happy "), "I'm Happy "sv);
     EXPECT_EQ(str::erase_comments("what's cmt"), "what's cmt"sv);
 }
+
+TEST(GlobMatch, Default)
+{
+    EXPECT_TRUE(str::glob_match("pool.*", "pool.size"));
+    EXPECT_TRUE(str::glob_match("pool.*", "pool."));
+    EXPECT_TRUE(str::glob_match("*.size", "pool.size"));
+    EXPECT_TRUE(str::glob_match("p?ol.*ze", "pool.size"));
+    EXPECT_TRUE(str::glob_match("*", ""));
+    EXPECT_TRUE(str::glob_match("a*b*c", "aXbYbZc"));
+    EXPECT_TRUE(str::glob_match("exact", "exact"));
+}
+
+TEST(GlobMatch, NoMatch)
+{
+    EXPECT_FALSE(str::glob_match("pool.*", "pool"));
+    EXPECT_FALSE(str::glob_match("pool.*", "spool.size"));
+    EXPECT_FALSE(str::glob_match("?", ""));
+    EXPECT_FALSE(str::glob_match("a*b*c", "aXbYbZ"));
+    EXPECT_FALSE(str::glob_match("exact", "exact!"));
+}
+
+TEST(GlobPrefix, Default)
+{
+    EXPECT_EQ(str::glob_prefix("pool.*"),  "pool."sv);
+    EXPECT_EQ(str::glob_prefix("p?ol.*"),  "p"sv);
+    EXPECT_EQ(str::glob_prefix("*"),       ""sv);
+    EXPECT_EQ(str::glob_prefix("exact"),   "exact"sv);
+}
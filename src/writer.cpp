@@ -0,0 +1,64 @@
+#include "inifile/writer.h"
+
+#include <algorithm>
+
+namespace ini
+{
+
+Writer& Writer::section(std::string_view name)
+{
+    // Empty line after each section.
+    if (in_section_)
+    {
+        append("\n");
+    }
+    in_section_ = true;
+
+    append("[");
+    append(name);
+    append("]\n");
+    return *this;
+}
+
+Writer& Writer::put(std::string_view key, std::string_view value)
+{
+    append(key);
+    append(" = ");
+    append(value);
+    append("\n");
+    return *this;
+}
+
+void Writer::finish()
+{
+    if (in_section_)
+    {
+        append("\n");
+        in_section_ = false;
+    }
+    flush();
+}
+
+void Writer::flush()
+{
+    output_.write(buffer_.data(), static_cast<std::streamsize>(size_));
+    size_ = 0;
+}
+
+void Writer::append(std::string_view str)
+{
+    while (!str.empty())
+    {
+        if (size_ == buffer_.size())
+        {
+            flush();
+        }
+
+        auto count = std::min(str.size(), buffer_.size() - size_);
+        std::copy_n(str.data(), count, buffer_.data() + size_);
+        size_ += count;
+        str.remove_prefix(count);
+    }
+}
+
+} // namespace ini
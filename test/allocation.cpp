@@ -0,0 +1,96 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace
+{
+    std::size_t allocations = 0;
+
+    /// Build an input of sorted sections and keys, all too long for small-string storage.
+    std::string make_input(int sections, int keys)
+    {
+        std::string input;
+        for (int i = 0; i < sections; ++i)
+        {
+            input += "[a section with a long name " + std::to_string(i) + "]\n";
+            for (int j = 0; j < keys; ++j)
+            {
+                input += "a key with a long name " + std::to_string(j) + " = a value with a long content\n";
+            }
+        }
+        return input;
+    }
+} // anonymous namespace
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC can not see that the replaced operator new pairs with std::free().
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+/// Every stored string and map node is allocated exactly once.
+TEST(Allocation, DecodeString)
+{
+    constexpr int sections = 10;
+    constexpr int keys = 10;
+    auto input = make_input(sections, keys);
+
+    ini::File file;
+    allocations = 0;
+    ASSERT_TRUE(file.decode(input));
+    auto count = allocations;
+
+    // A node and a name for each section.
+    // A node, a key and a value for each key.
+    EXPECT_EQ(count, sections * 2 + sections * keys * 3);
+}
+
+/// Decoding the same input again only overwrites the values in place.
+TEST(Allocation, DecodeAgain)
+{
+    auto input = make_input(10, 10);
+
+    ini::File file;
+    ASSERT_TRUE(file.decode(input));
+
+    allocations = 0;
+    ASSERT_TRUE(file.decode(input));
+    EXPECT_EQ(allocations, 0);
+}
+
+/// Unsorted input costs the same.
+TEST(Allocation, Unsorted)
+{
+    std::string input = "[b long section name here]\nz long key name here = v long value content here\n"
+                        "a long key name here = v long value content here\n"
+                        "[a long section name here]\nk long key name here = v long value content here\n";
+
+    ini::File file;
+    allocations = 0;
+    ASSERT_TRUE(file.decode(input));
+    EXPECT_EQ(allocations, 2 * 2 + 3 * 3);
+}
@@ -0,0 +1,220 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// A coroutine that starts at once and reports its end through a promise.
+    struct Task
+    {
+        struct promise_type
+        {
+            Task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    /// A coroutine that starts at once and is destroyed by its caller.
+    struct OwnedTask
+    {
+        struct promise_type
+        {
+            OwnedTask get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    OwnedTask await_blocked(std::atomic<bool>& release, bool& resumed)
+    {
+        co_await ini::AsyncResult([&release] {
+            while (!release)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return true;
+        });
+        resumed = true;
+    }
+
+    /// A minimal event loop: handles posted from any thread are resumed by run().
+    class EventLoop
+    {
+      public:
+        ini::Executor executor()
+        {
+            return [this](std::coroutine_handle<> handle) {
+                {
+                    std::lock_guard lock(mutex_);
+                    queue_.push_back(handle);
+                }
+                ready_.notify_one();
+            };
+        }
+
+        /// Resume posted handles until stop is true.
+        void run(bool const& stop)
+        {
+            while (!stop)
+            {
+                std::unique_lock lock(mutex_);
+                ready_.wait(lock, [this] { return !queue_.empty(); });
+                auto handle = queue_.front();
+                queue_.pop_front();
+                lock.unlock();
+                handle.resume();
+            }
+        }
+
+      private:
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::coroutine_handle<>> queue_;
+    };
+
+    Task read_on_loop(std::atomic<bool>& release, ini::File& file, std::filesystem::path path, EventLoop& loop,
+                      std::vector<std::thread::id>& resumed_on, bool& done)
+    {
+        // Blocked until the loop runs, so the coroutine is suspended for sure.
+        co_await ini::AsyncResult([&release] {
+            while (!release)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return true;
+        }, loop.executor());
+        resumed_on.push_back(std::this_thread::get_id());
+
+        co_await file.async_read(path, loop.executor());
+        resumed_on.push_back(std::this_thread::get_id());
+        done = true;
+    }
+
+    Task write_then_read(ini::File const& output, ini::File& input, std::filesystem::path path, std::promise<bool>& done)
+    {
+        bool written = co_await output.async_write(path);
+        bool read = co_await input.async_read(path);
+        done.set_value(written && read);
+    }
+
+    Task read_missing(ini::File& file, std::promise<bool>& done)
+    {
+        done.set_value(co_await file.async_read("/nonexistent/inifile/path.ini"));
+    }
+} // anonymous namespace
+
+/// Write a file in background and read it back in background.
+TEST(Async, WriteThenRead)
+{
+    auto path = std::filesystem::temp_directory_path() / "inifile_test_async.ini";
+
+    ini::File output;
+    output["Section"]["key"] = "value";
+    output["Section"]["number"] = "42";
+    ASSERT_TRUE(output.async_write(path).get());
+
+    ini::File input;
+    ASSERT_TRUE(input.async_read(path).get());
+    EXPECT_EQ(input["Section"]["key"].as_str(), "value");
+    EXPECT_EQ(input["Section"]["number"].to<int>(), 42);
+
+    std::filesystem::remove(path);
+}
+
+/// Errors are reported through the future.
+TEST(Async, MissingFile)
+{
+    ini::File file;
+    EXPECT_FALSE(file.async_read("/nonexistent/inifile/path.ini").get());
+    EXPECT_FALSE(file.eroor().empty());
+}
+
+/// Operations can be awaited by a coroutine.
+TEST(Async, Coroutine)
+{
+    auto path = std::filesystem::temp_directory_path() / "inifile_test_async_coroutine.ini";
+
+    ini::File output;
+    output["Section"]["key"] = "value";
+    ini::File input;
+
+    std::promise<bool> done;
+    write_then_read(output, input, path, done);
+    ASSERT_TRUE(done.get_future().get());
+    EXPECT_EQ(input["Section"]["key"].as_str(), "value");
+
+    std::filesystem::remove(path);
+}
+
+/// Errors are reported as the result of co_await.
+TEST(Async, CoroutineMissingFile)
+{
+    ini::File file;
+    std::promise<bool> done;
+    read_missing(file, done);
+    EXPECT_FALSE(done.get_future().get());
+    EXPECT_FALSE(file.eroor().empty());
+}
+
+/// An executor resumes the coroutine on the thread of its event loop.
+TEST(Async, Executor)
+{
+    auto path = std::filesystem::temp_directory_path() / "inifile_test_async_executor.ini";
+    ini::File output;
+    output["Section"]["key"] = "value";
+    ASSERT_TRUE(output.write(path));
+
+    std::atomic<bool> release = false;
+    EventLoop loop;
+    ini::File input;
+    std::vector<std::thread::id> resumed_on;
+    bool done = false;
+    read_on_loop(release, input, path, loop, resumed_on, done);
+    release = true;
+    loop.run(done);
+
+    ASSERT_EQ(resumed_on.size(), 2);
+    EXPECT_EQ(resumed_on[0], std::this_thread::get_id());
+    EXPECT_EQ(resumed_on[1], std::this_thread::get_id());
+    EXPECT_EQ(input["Section"]["key"].as_str(), "value");
+
+    std::filesystem::remove(path);
+}
+
+/// Destroying a coroutine suspended on an operation cancels its resumption.
+TEST(Async, DestroySuspended)
+{
+    std::atomic<bool> release = false;
+    bool resumed = false;
+    auto task = await_blocked(release, resumed);
+    ASSERT_FALSE(task.handle.done());
+
+    // The destructor of the awaited result waits for the operation, so finish it from another thread.
+    std::thread releaser([&release] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release = true;
+    });
+    task.handle.destroy();
+    releaser.join();
+
+    EXPECT_FALSE(resumed);
+}
@@ -0,0 +1,69 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <vector>
+
+/// A valid input produces no diagnostics.
+TEST(Diagnostics, Valid)
+{
+    ini::File file;
+    std::vector<ini::Diagnostic> diagnostics;
+    ASSERT_TRUE(file.decode("[Section]\nkey = value\n", diagnostics));
+    EXPECT_TRUE(diagnostics.empty());
+}
+
+/// All errors are collected and valid lines between them are kept.
+TEST(Diagnostics, CollectAll)
+{
+    ini::File file;
+    std::vector<ini::Diagnostic> diagnostics;
+    EXPECT_FALSE(file.decode("orphan = 1\n[Section]\nkey = value\n  bad line\nother = 2\n[broken\n", diagnostics));
+
+    ASSERT_EQ(diagnostics.size(), 3);
+
+    EXPECT_EQ(diagnostics[0].kind, ini::Diagnostic::Kind::MissingSection);
+    EXPECT_EQ(diagnostics[0].line, 1);
+    EXPECT_EQ(diagnostics[0].column, 1);
+    EXPECT_EQ(diagnostics[0].offset, 0);
+
+    EXPECT_EQ(diagnostics[1].kind, ini::Diagnostic::Kind::InvalidLine);
+    EXPECT_EQ(diagnostics[1].line, 4);
+    EXPECT_EQ(diagnostics[1].column, 3);
+    EXPECT_EQ(diagnostics[1].offset, 35);
+
+    EXPECT_EQ(diagnostics[2].kind, ini::Diagnostic::Kind::InvalidLine);
+    EXPECT_EQ(diagnostics[2].line, 6);
+    EXPECT_EQ(diagnostics[2].column, 1);
+    EXPECT_EQ(diagnostics[2].offset, 54);
+
+    EXPECT_EQ(file["Section"]["key"].as_str(), "value");
+    EXPECT_EQ(file["Section"]["other"].as_str(), "2");
+    EXPECT_EQ(file.eroor(), "Syntax error at line 1: Expected a section name");
+}
+
+/// Stream input reports the same positions.
+TEST(Diagnostics, Stream)
+{
+    std::stringstream stream("[Section]\r\n\tkey\r\n");
+
+    ini::File file;
+    std::vector<ini::Diagnostic> diagnostics;
+    EXPECT_FALSE(file.decode(stream, diagnostics));
+
+    ASSERT_EQ(diagnostics.size(), 1);
+    EXPECT_EQ(diagnostics[0].line, 2);
+    EXPECT_EQ(diagnostics[0].column, 2);
+    EXPECT_EQ(diagnostics[0].offset, 12);
+    EXPECT_EQ(diagnostics[0].message(), "Invalid line");
+}
+
+/// Without diagnostics, decoding stops at the first error.
+TEST(Diagnostics, StopAtFirstError)
+{
+    ini::File file;
+    EXPECT_FALSE(file.decode("[Section]\nbad\nkey = value\n"));
+    EXPECT_EQ(file.eroor(), "Syntax error at line 2");
+    EXPECT_EQ(file["Section"].size(), 0);
+}
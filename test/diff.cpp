@@ -0,0 +1,145 @@
+#include "inifile/diff.h"
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    ini::File decode(std::string_view str)
+    {
+        ini::File file;
+        EXPECT_TRUE(file.decode(str));
+        return file;
+    }
+} // anonymous namespace
+
+/// Identical files have no difference.
+TEST(Diff, Identical)
+{
+    auto file = decode("[A]\nkey = value\n[B]\nkey = value\n");
+    EXPECT_TRUE(ini::diff(file, file).empty());
+}
+
+/// Every kind of change is found in sorted order.
+TEST(Diff, AllKinds)
+{
+    auto from = decode("[A]\nkeep = 1\nchange = 1\nremove = 1\n[B]\nkey = 1\n");
+    auto to = decode("[A]\nadd = 1\nkeep = 1\nchange = 2\n[C]\nkey = 1\n");
+
+    auto patch = ini::diff(from, to);
+    ASSERT_EQ(patch.size(), 3);
+
+    using Section = ini::SectionChange::Kind;
+    using Key = ini::KeyChange::Kind;
+    EXPECT_EQ(patch[0].kind, Section::Modify);
+    EXPECT_EQ(patch[0].section, "A");
+    ASSERT_EQ(patch[0].keys.size(), 3);
+    EXPECT_EQ(patch[0].keys[0].kind, Key::Add);
+    EXPECT_EQ(patch[0].keys[0].key, "add");
+    EXPECT_EQ(patch[0].keys[1].kind, Key::Change);
+    EXPECT_EQ(patch[0].keys[1].key, "change");
+    EXPECT_EQ(patch[0].keys[1].value, "2");
+    EXPECT_EQ(patch[0].keys[2].kind, Key::Remove);
+    EXPECT_EQ(patch[0].keys[2].key, "remove");
+    EXPECT_EQ(patch[1].kind, Section::Remove);
+    EXPECT_EQ(patch[1].section, "B");
+    EXPECT_TRUE(patch[1].keys.empty());
+    EXPECT_EQ(patch[2].kind, Section::Add);
+    EXPECT_EQ(patch[2].section, "C");
+    ASSERT_EQ(patch[2].keys.size(), 1);
+    EXPECT_EQ(patch[2].keys[0].kind, Key::Add);
+    EXPECT_EQ(patch[2].keys[0].key, "key");
+}
+
+/// Applying a diff gives the target.
+TEST(Diff, Apply)
+{
+    auto from = decode("[A]\nkeep = 1\nchange = 1\nremove = 1\n[B]\nkey = 1\n");
+    auto to = decode("[A]\nadd = 1\nkeep = 1\nchange = 2\n[C]\nkey = 1\n");
+
+    ini::apply(from, ini::diff(from, to));
+    EXPECT_EQ(from.encode(), to.encode());
+}
+
+/// An encoded patch decodes to the same changes, smaller than the target itself.
+TEST(Diff, Encode)
+{
+    auto from = decode("[A]\nkeep = 1\nchange = 1\nremove = 1\n[B]\nkey = 1\n");
+    std::string to_str = "[A]\nadd = 1\nkeep = 1\nchange = 2\n[C]\nkey = 1\n[a long section name]\n";
+    for (int i = 0; i < 100; ++i)
+    {
+        to_str += "key" + std::to_string(i) + " = " + std::to_string(i) + "\n";
+    }
+    auto to = decode(to_str);
+
+    auto encoded = ini::encode_patch(ini::diff(from, to));
+    EXPECT_LT(encoded.size(), to.encode().size());
+
+    auto patch = ini::decode_patch(encoded);
+    ASSERT_TRUE(patch.has_value());
+    ini::apply(from, *patch);
+    EXPECT_EQ(from.encode(), to.encode());
+
+    auto empty = ini::decode_patch(ini::encode_patch({}));
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_TRUE(empty->empty());
+}
+
+/// Truncated or malformed data is rejected.
+TEST(Diff, DecodeMalformed)
+{
+    auto from = decode("[A]\nx = 1\n[B]\ny = 1\n");
+    auto to = decode("[A]\nx = 2\n[C]\nz = 1\n");
+    auto encoded = ini::encode_patch(ini::diff(from, to));
+
+    for (std::size_t size = 0; size < encoded.size(); ++size)
+    {
+        EXPECT_FALSE(ini::decode_patch(std::string_view(encoded).substr(0, size)).has_value()) << size;
+    }
+    EXPECT_FALSE(ini::decode_patch(encoded + "x").has_value());
+    EXPECT_FALSE(ini::decode_patch("NOPE" + encoded.substr(4)).has_value());
+
+    // An unknown section kind.
+    auto bad_kind = encoded;
+    bad_kind[6] = 7;
+    EXPECT_FALSE(ini::decode_patch(bad_kind).has_value());
+}
+
+/// Independent changes on both sides are combined.
+TEST(Merge, Clean)
+{
+    auto base = decode("[A]\nx = 1\ny = 1\n[B]\nz = 1\n");
+    auto ours = decode("[A]\nx = 2\ny = 1\n[B]\nz = 1\n");
+    auto theirs = decode("[A]\nx = 1\ny = 3\n[C]\nw = 1\n");
+
+    auto result = ini::merge(base, ours, theirs);
+    EXPECT_TRUE(result.conflicts.empty());
+    EXPECT_EQ(result.file.encode(), decode("[A]\nx = 2\ny = 3\n[C]\nw = 1\n").encode());
+}
+
+/// The same change on both sides is not a conflict.
+TEST(Merge, SameChange)
+{
+    auto base = decode("[A]\nx = 1\n");
+    auto ours = decode("[A]\nx = 2\n");
+
+    auto result = ini::merge(base, ours, ours);
+    EXPECT_TRUE(result.conflicts.empty());
+    EXPECT_EQ(result.file.encode(), ours.encode());
+}
+
+/// Different changes on both sides conflict, and ours is kept.
+TEST(Merge, Conflict)
+{
+    auto base = decode("[A]\nx = 1\n[B]\ny = 1\n");
+    auto ours = decode("[A]\nx = 2\n");
+    auto theirs = decode("[A]\nx = 3\n[B]\ny = 2\n");
+
+    auto result = ini::merge(base, ours, theirs);
+    ASSERT_EQ(result.conflicts.size(), 2);
+    EXPECT_EQ(result.conflicts[0].section, "A");
+    EXPECT_EQ(result.conflicts[0].key, "x");
+    EXPECT_EQ(result.conflicts[1].section, "B");
+    EXPECT_EQ(result.conflicts[1].key, "");
+    EXPECT_EQ(result.file.encode(), ours.encode());
+}
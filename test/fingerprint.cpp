@@ -0,0 +1,119 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#define INI_UNUSED(expr) (void)(expr)
+
+/// Known answers of xxHash64.
+TEST(Hash64, KnownAnswer)
+{
+    EXPECT_EQ(ini::hash64(""), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(ini::hash64("a"), 0xD24EC4F1A98C6E5BULL);
+    EXPECT_EQ(ini::hash64("abc"), 0x44BC2CF5AD770999ULL);
+}
+
+/// Equal content gives equal fingerprints, regardless of the input order.
+TEST(Fingerprint, SameContent)
+{
+    ini::File lhs;
+    ini::File rhs;
+    ASSERT_TRUE(lhs.decode("[A]\nx = 1\ny = 2\n[B]\nz = 3\n"));
+    ASSERT_TRUE(rhs.decode("[B]\nz = 3\n[A]\ny = 2\nx = 1\n"));
+
+    EXPECT_EQ(lhs["A"].fingerprint(), rhs["A"].fingerprint());
+    EXPECT_EQ(lhs.fingerprint(), rhs.fingerprint());
+}
+
+/// A change only affects the fingerprint of its own section.
+TEST(Fingerprint, Change)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nx = 1\n[B]\nz = 3\n"));
+
+    auto a = file["A"].fingerprint();
+    auto b = file["B"].fingerprint();
+    auto whole = file.fingerprint();
+
+    file["A"]["x"] = "2";
+    EXPECT_NE(file["A"].fingerprint(), a);
+    EXPECT_EQ(file["B"].fingerprint(), b);
+    EXPECT_NE(file.fingerprint(), whole);
+
+    file["A"]["x"] = "1";
+    EXPECT_EQ(file["A"].fingerprint(), a);
+    EXPECT_EQ(file.fingerprint(), whole);
+}
+
+/// Keys and values are not interchangeable.
+TEST(Fingerprint, KeyValueSwap)
+{
+    ini::File lhs;
+    ini::File rhs;
+    ASSERT_TRUE(lhs.decode("[A]\nx = y\n"));
+    ASSERT_TRUE(rhs.decode("[A]\ny = x\n"));
+    EXPECT_NE(lhs.fingerprint(), rhs.fingerprint());
+}
+
+/// Adding a key changes the fingerprint.
+TEST(Fingerprint, AddKey)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nx = 1\n"));
+    auto before = file.fingerprint();
+
+    file["A"]["y"] = "";
+    EXPECT_NE(file.fingerprint(), before);
+}
+
+/// Readers sharing one const File may fingerprint it at the same time.
+TEST(Fingerprint, ConcurrentConst)
+{
+    ini::File file;
+    for (int i = 0; i < 100; ++i)
+    {
+        file["Section"]["key" + std::to_string(i)] = std::to_string(i);
+    }
+    ini::File const& shared = file;
+
+    std::vector<std::uint64_t> results(4);
+    std::vector<std::thread> threads;
+    for (auto& result : results)
+    {
+        threads.emplace_back([&shared, &result] { result = shared.fingerprint(); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (auto result : results)
+    {
+        EXPECT_EQ(result, results.front());
+    }
+
+    ini::File copy = file;
+    EXPECT_EQ(copy.fingerprint(), results.front());
+}
+
+/// A moved-from Field does not keep the hash of its old value.
+TEST(Fingerprint, MovedFrom)
+{
+    ini::Field field("value");
+    ini::Field empty("");
+    auto expected = empty.fingerprint();
+    INI_UNUSED(field.fingerprint());
+
+    ini::Field constructed(std::move(field));
+    EXPECT_EQ(field.as_str(), "");
+    EXPECT_EQ(field.fingerprint(), expected);
+
+    ini::Field assigned;
+    assigned = std::move(constructed);
+    EXPECT_EQ(constructed.as_str(), "");
+    EXPECT_EQ(constructed.fingerprint(), expected);
+    EXPECT_EQ(assigned.fingerprint(), ini::Field("value").fingerprint());
+}
@@ -0,0 +1,142 @@
+#include "inifile/inifile.h"
+#include "inifile/interpolate.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <string>
+
+#define INI_UNUSED(expr) (void)(expr)
+
+/// Values without references are returned as they are.
+TEST(Interpolate, Plain)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nx = 1\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_EQ(&interpolator.get("A", "x"), &file["A"]["x"]);
+}
+
+/// References are expanded recursively, and typed conversion works on the result.
+TEST(Interpolate, Reference)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nhost = localhost\nport = ${B:port}\n"
+                            "[B]\nport = 80${B:suffix}\nsuffix = 80\nurl = http://${A:host}:${A:port}/\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_EQ(interpolator.get("B", "url").as_str(), "http://localhost:8080/");
+    EXPECT_EQ(interpolator.get("A", "port").to<int>(), 8080);
+}
+
+/// Section names may contain ':'.
+TEST(Interpolate, ColonInSection)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[backend:a]\nhost = db\n[A]\nurl = http://${backend:a:host}/\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_EQ(interpolator.get("A", "url").as_str(), "http://db/");
+}
+
+/// Environment variables are expanded.
+TEST(Interpolate, Environment)
+{
+    ::setenv("INIFILE_TEST_HOME", "/home/ini", 1);
+
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\npath = ${INIFILE_TEST_HOME}/config\nbroken = ${unterminated\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_EQ(interpolator.get("A", "path").as_str(), "/home/ini/config");
+    EXPECT_EQ(interpolator.get("A", "broken").as_str(), "${unterminated");
+}
+
+/// Cycles and missing references are errors.
+TEST(Interpolate, Errors)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nx = ${A:y}\ny = ${A:x}\nz = ${A:missing}\nw = ${INIFILE_TEST_MISSING}\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_THROW(INI_UNUSED(interpolator.get("A", "x")), ini::InterpolationError);
+    EXPECT_THROW(INI_UNUSED(interpolator.get("A", "z")), ini::InterpolationError);
+    EXPECT_THROW(INI_UNUSED(interpolator.get("A", "w")), ini::InterpolationError);
+    EXPECT_THROW(INI_UNUSED(interpolator.get("B", "x")), ini::InterpolationError);
+}
+
+/// Only dependents of a changed key are expanded again.
+TEST(Interpolate, Invalidate)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nbase = 1\nderived = ${A:base}+\nother = ${A:unrelated}\nunrelated = u\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_EQ(interpolator.get("A", "derived").as_str(), "1+");
+    auto const* other = &interpolator.get("A", "other");
+    EXPECT_EQ(other->as_str(), "u");
+
+    file["A"]["base"] = "2";
+    interpolator.invalidate("A", "base");
+    EXPECT_EQ(interpolator.get("A", "derived").as_str(), "2+");
+    EXPECT_EQ(&interpolator.get("A", "other"), other);
+}
+
+/// A missing key becomes available after it is added.
+TEST(Interpolate, AddMissing)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nx = ${B:y}\n"));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_THROW(INI_UNUSED(interpolator.get("A", "x")), ini::InterpolationError);
+
+    file["B"]["y"] = "added";
+    interpolator.invalidate("B", "y");
+    EXPECT_EQ(interpolator.get("A", "x").as_str(), "added");
+}
+
+/// Long reference chains do not overflow the stack, when expanded or invalidated.
+TEST(Interpolate, LongChain)
+{
+    constexpr int LENGTH = 200000;
+    std::string text = "[A]\n";
+    for (int i = 0; i < LENGTH; ++i)
+    {
+        text += "k" + std::to_string(i) + " = ${A:k" + std::to_string(i + 1) + "}\n";
+    }
+    text += "k" + std::to_string(LENGTH) + " = end\n";
+
+    ini::File file;
+    ASSERT_TRUE(file.decode(text));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_EQ(interpolator.get("A", "k0").as_str(), "end");
+
+    file["A"]["k" + std::to_string(LENGTH)] = "changed";
+    interpolator.invalidate("A", "k" + std::to_string(LENGTH));
+    EXPECT_EQ(interpolator.get("A", "k0").as_str(), "changed");
+}
+
+/// Exponential expansion stops at the limits.
+TEST(Interpolate, Limits)
+{
+    std::string text = "[A]\n";
+    for (int i = 0; i < 64; ++i)
+    {
+        text += "k" + std::to_string(i) + " = ${A:k" + std::to_string(i + 1) + "}${A:k" + std::to_string(i + 1) + "}\n";
+    }
+    text += "k64 = x\n";
+
+    ini::File file;
+    ASSERT_TRUE(file.decode(text));
+
+    ini::Interpolator interpolator(file);
+    EXPECT_THROW(INI_UNUSED(interpolator.get("A", "k0")), ini::InterpolationError);
+    EXPECT_EQ(interpolator.get("A", "k60").as_str(), "xxxxxxxxxxxxxxxx");
+
+    ini::Interpolator small(file, ini::InterpolationLimits{.max_value_size = 1000, .max_total_size = 100});
+    EXPECT_THROW(INI_UNUSED(small.get("A", "k56")), ini::InterpolationError);
+    EXPECT_EQ(small.get("A", "k60").as_str(), "xxxxxxxxxxxxxxxx");
+}
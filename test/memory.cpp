@@ -0,0 +1,105 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+namespace
+{
+    /// Values longer than any inline string, each with extra capacity.
+    ini::File make_fragmented_file()
+    {
+        ini::File file;
+        for (int i = 0; i < 100; ++i)
+        {
+            auto& section = file["section" + std::to_string(i)];
+            for (int j = 0; j < 10; ++j)
+            {
+                std::string value(40, 'v');
+                value.reserve(200);
+                section["a.rather.long.key.name." + std::to_string(j)] = std::move(value);
+            }
+        }
+        return file;
+    }
+} // anonymous namespace
+
+TEST(MemoryUsage, Empty)
+{
+    ini::File file;
+    auto usage = file.memory_usage();
+    EXPECT_EQ(usage.nodes, 0);
+    EXPECT_EQ(usage.strings, 0);
+    EXPECT_EQ(usage.slack, 0);
+    EXPECT_EQ(usage.total(), 0);
+}
+
+/// Short strings live inside the nodes.
+TEST(MemoryUsage, ShortStrings)
+{
+    ini::File file;
+    file["a"]["b"] = "c";
+    file["a"]["d"] = "e";
+
+    auto usage = file.memory_usage();
+    EXPECT_GT(usage.nodes, 3 * sizeof(ini::Field));
+    EXPECT_EQ(usage.strings, 0);
+    EXPECT_EQ(usage.slack, 0);
+}
+
+TEST(MemoryUsage, LongStrings)
+{
+    ini::File file;
+    std::string value(100, 'x');
+    value.reserve(300);
+    file["a"]["b"] = std::move(value);
+
+    auto usage = file.memory_usage();
+    EXPECT_EQ(usage.strings, 101);
+    EXPECT_GE(usage.slack, 200);
+    EXPECT_EQ(usage.total(), usage.nodes + usage.strings + usage.slack);
+}
+
+/// Compaction frees the slack and keeps the content.
+TEST(Compact, RemoveSlack)
+{
+    auto file = make_fragmented_file();
+    auto encoded = file.encode();
+    auto fingerprint = file.fingerprint();
+    auto before = file.memory_usage();
+    ASSERT_GT(before.slack, 0);
+
+    file.compact();
+
+    auto after = file.memory_usage();
+    EXPECT_EQ(after.nodes, before.nodes);
+    EXPECT_EQ(after.strings, before.strings);
+    EXPECT_EQ(after.slack, 0);
+    EXPECT_LT(after.total(), before.total());
+
+    EXPECT_EQ(file.encode(), encoded);
+    EXPECT_EQ(file.fingerprint(), fingerprint);
+}
+
+/// Compaction keeps the settings of the File.
+TEST(Compact, KeepLimits)
+{
+    ini::File file;
+    file.set_limits(ini::Limits{.max_sections = 1});
+    file["a"]["b"] = "c";
+    file.compact();
+
+    EXPECT_EQ(file.limits().max_sections, 1);
+    EXPECT_EQ(file["a"]["b"].as_str(), "c");
+
+    file.clear();
+    EXPECT_FALSE(file.decode("[a]\nb = c\n[d]\ne = f\n"));
+}
+
+TEST(Compact, Empty)
+{
+    ini::File file;
+    file.compact();
+    EXPECT_TRUE(file.empty());
+    EXPECT_EQ(file.memory_usage().total(), 0);
+}
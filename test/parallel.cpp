@@ -0,0 +1,101 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    std::string slurp(std::filesystem::path const& path)
+    {
+        std::ifstream stream(path);
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+        return buffer.str();
+    }
+
+    /// About 8 MiB of output, with sections of very different sizes.
+    ini::File make_large_file()
+    {
+        ini::File file;
+        for (int i = 0; i < 2000; ++i)
+        {
+            auto& section = file["section" + std::to_string(i)];
+            for (int j = 0; j < (i % 7 + 1) * 20; ++j)
+            {
+                section["key" + std::to_string(j)] = std::string(static_cast<std::size_t>(j % 50), 'v');
+            }
+        }
+        return file;
+    }
+
+    std::filesystem::path temporary_file(std::string const& name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+} // anonymous namespace
+
+/// Writing on many threads gives the same bytes as the serial encoder.
+TEST(ParallelEncode, SameAsSerial)
+{
+    auto file = make_large_file();
+    auto expected = file.encode();
+    auto path = temporary_file("inifile_test_parallel.ini");
+
+    for (unsigned threads : {0U, 1U, 2U, 3U, 8U, 64U})
+    {
+        ASSERT_TRUE(file.write(path, ini::WriteOptions{.threads = threads})) << file.eroor();
+        EXPECT_EQ(slurp(path), expected) << "threads = " << threads;
+    }
+
+    std::filesystem::remove(path);
+}
+
+/// Atomic writes take the same path.
+TEST(ParallelEncode, Atomic)
+{
+    auto file = make_large_file();
+    auto path = temporary_file("inifile_test_parallel_atomic.ini");
+
+    ASSERT_TRUE(file.write(path, ini::WriteOptions{.atomic = true, .threads = 4}));
+    EXPECT_EQ(slurp(path), file.encode());
+
+    std::filesystem::remove(path);
+}
+
+/// Small and empty documents are not split.
+TEST(ParallelEncode, Small)
+{
+    auto path = temporary_file("inifile_test_parallel_small.ini");
+
+    ini::File file;
+    ASSERT_TRUE(file.write(path, ini::WriteOptions{.threads = 4}));
+    EXPECT_EQ(slurp(path), "");
+
+    file["a"]["key"] = "value";
+    file["b"]["key"] = "1";
+    ASSERT_TRUE(file.write(path, ini::WriteOptions{.threads = 4}));
+    EXPECT_EQ(slurp(path), file.encode());
+
+    std::filesystem::remove(path);
+}
+
+/// A single section larger than everything else still works.
+TEST(ParallelEncode, OneHugeSection)
+{
+    ini::File file;
+    for (int i = 0; i < 100000; ++i)
+    {
+        file["huge"]["key" + std::to_string(i)] = std::string(32, 'x');
+    }
+    file["tiny"]["key"] = "value";
+    auto path = temporary_file("inifile_test_parallel_huge.ini");
+
+    ASSERT_TRUE(file.write(path, ini::WriteOptions{.threads = 4}));
+    EXPECT_EQ(slurp(path), file.encode());
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,87 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    template<typename Range>
+    std::vector<std::string> names(Range const& range)
+    {
+        std::vector<std::string> result;
+        for (auto const& item : range)
+        {
+            result.push_back(item.first);
+        }
+        return result;
+    }
+
+    template<typename Iterator>
+    std::vector<std::string> names(std::vector<Iterator> const& iterators)
+    {
+        std::vector<std::string> result;
+        for (auto const& it : iterators)
+        {
+            result.push_back(it->first);
+        }
+        return result;
+    }
+
+    using Names = std::vector<std::string>;
+} // anonymous namespace
+
+/// Sections are selected by the prefix of their names.
+TEST(Query, SectionsWithPrefix)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[backend:a]\nk=1\n[backend:b]\nk=1\n[backend]\nk=1\n[backends]\nk=1\n[frontend:a]\nk=1\n"));
+
+    EXPECT_EQ(names(file.sections_with_prefix("backend:")), (Names{"backend:a", "backend:b"}));
+    EXPECT_EQ(names(file.sections_with_prefix("backend")), (Names{"backend", "backend:a", "backend:b", "backends"}));
+    EXPECT_EQ(names(file.sections_with_prefix("")).size(), 5);
+    EXPECT_TRUE(file.sections_with_prefix("none").empty());
+
+    auto const& const_file = file;
+    EXPECT_EQ(names(const_file.sections_with_prefix("frontend")), (Names{"frontend:a"}));
+}
+
+/// Prefixes ending with the largest char are handled.
+TEST(Query, HighChar)
+{
+    ini::File file;
+    file["a\xff"]["k"] = "1";
+    file["a\xff\xff"]["k"] = "1";
+    file["b"]["k"] = "1";
+
+    EXPECT_EQ(names(file.sections_with_prefix("a\xff")), (Names{"a\xff", "a\xff\xff"}));
+}
+
+/// Keys are selected by prefix or by glob pattern.
+TEST(Query, Keys)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[S]\npool.max=1\npool.min=2\npoolside=3\nqueue.max=4\n"));
+    auto const& section = file["S"];
+
+    EXPECT_EQ(names(section.keys_with_prefix("pool.")), (Names{"pool.max", "pool.min"}));
+    EXPECT_EQ(names(section.keys_matching("pool.*")), (Names{"pool.max", "pool.min"}));
+    EXPECT_EQ(names(section.keys_matching("*.max")), (Names{"pool.max", "queue.max"}));
+    EXPECT_EQ(names(section.keys_matching("pool?m?n")), (Names{"pool.min"}));
+    EXPECT_EQ(names(file.sections_matching("?")), (Names{"S"}));
+}
+
+/// Values can be modified through a prefix range.
+TEST(Query, Modify)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode("[S]\npool.max=1\npool.min=2\n"));
+
+    for (auto& [key, value] : file["S"].keys_with_prefix("pool."))
+    {
+        value = "0";
+    }
+    EXPECT_EQ(file["S"]["pool.max"].as_str(), "0");
+    EXPECT_EQ(file["S"]["pool.min"].as_str(), "0");
+}
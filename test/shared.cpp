@@ -0,0 +1,250 @@
+#include "inifile/inifile.h"
+#include "inifile/shared.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    /// A segment name unique to this test process.
+    std::string segment_name(std::string const& suffix)
+    {
+        return "/inifile_test_" + std::to_string(::getpid()) + "_" + suffix;
+    }
+} // anonymous namespace
+
+/// Nothing can be read before the first publish.
+TEST(Shared, Empty)
+{
+    auto name = segment_name("empty");
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 1024)) << publisher.error();
+
+    ini::SharedSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(name)) << subscriber.error();
+    EXPECT_EQ(subscriber.generation(), 0);
+    EXPECT_FALSE(subscriber.find("A", "x"));
+
+    ini::File file;
+    EXPECT_FALSE(subscriber.load(file));
+
+    ini::SharedPublisher::remove(name);
+}
+
+/// Published versions are found and loaded by subscribers.
+TEST(Shared, PublishAndRead)
+{
+    auto name = segment_name("publish");
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 4096)) << publisher.error();
+
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\nx = 1\ny = 2\n[B]\nz = 3\n"));
+    file["Empty"];
+    ASSERT_TRUE(publisher.publish(file)) << publisher.error();
+
+    ini::SharedSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(name)) << subscriber.error();
+    EXPECT_EQ(subscriber.generation(), 1);
+    EXPECT_EQ(subscriber.find("A", "y"), "2");
+    EXPECT_EQ(subscriber.find("B", "z"), "3");
+    EXPECT_FALSE(subscriber.find("A", "z"));
+    EXPECT_FALSE(subscriber.find("C", "x"));
+
+    ini::File loaded;
+    ASSERT_TRUE(subscriber.load(loaded));
+    EXPECT_EQ(loaded.encode(), file.encode());
+    EXPECT_EQ(loaded.size(), 3);
+
+    file["A"]["x"] = "changed";
+    ASSERT_TRUE(publisher.publish(file));
+    EXPECT_EQ(subscriber.generation(), 2);
+    EXPECT_EQ(subscriber.find("A", "x"), "changed");
+
+    ini::SharedPublisher::remove(name);
+}
+
+/// Documents larger than the capacity are rejected, and the old version stays.
+TEST(Shared, TooLarge)
+{
+    auto name = segment_name("large");
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 64));
+
+    ini::File small;
+    small["A"]["x"] = "1";
+    ASSERT_TRUE(publisher.publish(small));
+
+    ini::File large;
+    large["A"]["x"] = std::string(100, 'x');
+    EXPECT_FALSE(publisher.publish(large));
+    EXPECT_FALSE(publisher.error().empty());
+
+    ini::SharedSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(name));
+    EXPECT_EQ(subscriber.find("A", "x"), "1");
+
+    ini::SharedPublisher::remove(name);
+}
+
+/// A publisher restarted after a crash in the middle of a publish still publishes readable versions.
+TEST(Shared, RestartAfterCrash)
+{
+    auto name = segment_name("restart");
+    ini::File file;
+    file["A"]["x"] = "1";
+    {
+        ini::SharedPublisher publisher;
+        ASSERT_TRUE(publisher.open(name, 1024));
+        ASSERT_TRUE(publisher.publish(file));
+    }
+
+    // Leave the slot written by the next publish marked as being written.
+    // Layout: a 32-byte segment header, then the slots, each starting with its seq.
+    {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        ASSERT_GE(fd, 0);
+        struct stat info{};
+        ASSERT_EQ(::fstat(fd, &info), 0);
+        auto size = static_cast<std::size_t>(info.st_size);
+        void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        ASSERT_NE(memory, MAP_FAILED);
+
+        std::uint64_t seq = 3;
+        std::memcpy(static_cast<std::byte*>(memory) + 32, &seq, sizeof(seq));
+        ::munmap(memory, size);
+    }
+
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 1024));
+    file["A"]["x"] = "2";
+    ASSERT_TRUE(publisher.publish(file));
+
+    ini::SharedSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(name));
+    EXPECT_EQ(subscriber.generation(), 2);
+    EXPECT_EQ(subscriber.find("A", "x"), "2");
+
+    ini::SharedPublisher::remove(name);
+}
+
+/// Subscribers of a replaced segment are told to open it again.
+TEST(Shared, Superseded)
+{
+    auto name = segment_name("superseded");
+    ini::File file;
+    file["A"]["x"] = "1";
+
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 1024));
+    ASSERT_TRUE(publisher.publish(file));
+
+    ini::SharedSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(name));
+    EXPECT_FALSE(subscriber.superseded());
+
+    ini::SharedPublisher resized;
+    ASSERT_TRUE(resized.open(name, 4096));
+    file["A"]["x"] = "2";
+    ASSERT_TRUE(resized.publish(file));
+
+    EXPECT_TRUE(subscriber.superseded());
+    EXPECT_EQ(subscriber.find("A", "x"), "1");
+
+    ASSERT_TRUE(subscriber.open(name));
+    EXPECT_FALSE(subscriber.superseded());
+    EXPECT_EQ(subscriber.find("A", "x"), "2");
+
+    ini::SharedPublisher::remove(name);
+}
+
+/// Segments are private to their owner unless asked otherwise.
+TEST(Shared, Mode)
+{
+    auto name = segment_name("mode");
+    auto mode_of = [&name] {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        struct stat info{};
+        ::fstat(fd, &info);
+        ::close(fd);
+        return info.st_mode & 0777;
+    };
+
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 1024));
+    EXPECT_EQ(mode_of(), 0600);
+
+    ini::SharedPublisher shared;
+    ASSERT_TRUE(shared.open(name, 1024, 0644));
+    EXPECT_EQ(mode_of(), 0644);
+
+    ini::SharedPublisher::remove(name);
+}
+
+/// Readers in another process always see a complete version while publishing goes on.
+TEST(Shared, ConcurrentProcess)
+{
+    auto name = segment_name("concurrent");
+    ini::SharedPublisher publisher;
+    ASSERT_TRUE(publisher.open(name, 1 << 16));
+
+    auto make = [](int version) {
+        ini::File file;
+        for (int i = 0; i < 20; ++i)
+        {
+            file["Section " + std::to_string(i)]["version"] = std::to_string(version);
+        }
+        return file;
+    };
+    ASSERT_TRUE(publisher.publish(make(0)));
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        ini::SharedSubscriber subscriber;
+        if (!subscriber.open(name))
+        {
+            ::_exit(2);
+        }
+        for (int round = 0; round < 2000; ++round)
+        {
+            ini::File file;
+            if (!subscriber.load(file))
+            {
+                ::_exit(3);
+            }
+            for (auto const& [section_name, section] : file)
+            {
+                if (section.at("version").as_str() != file.begin()->second.at("version").as_str())
+                {
+                    ::_exit(1);
+                }
+            }
+        }
+        ::_exit(0);
+    }
+
+    for (int version = 1; version < 2000; ++version)
+    {
+        ASSERT_TRUE(publisher.publish(make(version)));
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    ini::SharedPublisher::remove(name);
+}
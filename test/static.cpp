@@ -0,0 +1,82 @@
+#include "inifile/inifile.h"
+#include "inifile/static.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string_view>
+
+#define INI_UNUSED(expr) (void)(expr)
+
+using namespace std::string_view_literals;
+
+namespace
+{
+    constexpr auto DEFAULTS_TEXT = R"(
+# Built-in defaults.
+[server]
+port = 8080
+host = localhost ; inline comment
+verbose = false
+
+[limits]
+min = -9223372036854775808
+max = 255
+port = 1
+port = 2
+)"sv;
+
+    constexpr auto DEFAULTS = ini::static_decode<ini::static_capacity(DEFAULTS_TEXT)>(DEFAULTS_TEXT);
+} // anonymous namespace
+
+// Everything below is checked by the compiler.
+static_assert(DEFAULTS.size() == 6);
+static_assert(DEFAULTS.get<int>("server", "port") == 8080);
+static_assert(DEFAULTS.get<std::string_view>("server", "host") == "localhost");
+static_assert(!DEFAULTS.get<bool>("server", "verbose"));
+static_assert(DEFAULTS.get<std::int64_t>("limits", "min") == INT64_MIN);
+static_assert(DEFAULTS.get<std::uint8_t>("limits", "max") == 255);
+static_assert(DEFAULTS.get<int>("limits", "port") == 2);
+static_assert(!DEFAULTS.find("server", "missing"));
+static_assert(ini::str::trim("  key ") == "key");
+
+/// Entries are sorted by section and key.
+TEST(StaticFile, Sorted)
+{
+    std::string_view previous_section;
+    std::string_view previous_key;
+    for (auto const& entry : DEFAULTS)
+    {
+        EXPECT_TRUE(previous_section < entry.section || (previous_section == entry.section && previous_key < entry.key));
+        previous_section = entry.section;
+        previous_key = entry.key;
+    }
+}
+
+/// The static table has the same content as File::decode().
+TEST(StaticFile, SameAsFile)
+{
+    ini::File file;
+    ASSERT_TRUE(file.decode(DEFAULTS_TEXT));
+
+    std::size_t count = 0;
+    for (auto const& [name, section] : file)
+    {
+        for (auto const& [key, value] : section)
+        {
+            EXPECT_EQ(DEFAULTS.find(name, key), value.as_str());
+            ++count;
+        }
+    }
+    EXPECT_EQ(count, DEFAULTS.size());
+}
+
+/// Conversion errors are thrown when evaluated at runtime.
+TEST(StaticFile, RuntimeError)
+{
+    EXPECT_THROW(INI_UNUSED(DEFAULTS.get<int>("server", "host")), ini::DecodeError);
+    EXPECT_THROW(INI_UNUSED(DEFAULTS.get<std::int8_t>("limits", "max")), ini::DecodeError);
+    EXPECT_THROW(INI_UNUSED(DEFAULTS.get<unsigned>("limits", "min")), ini::DecodeError);
+    EXPECT_THROW(INI_UNUSED(DEFAULTS.get<bool>("server", "port")), ini::DecodeError);
+    EXPECT_THROW(INI_UNUSED(DEFAULTS.get<int>("server", "missing")), ini::DecodeError);
+}
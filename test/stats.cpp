@@ -0,0 +1,74 @@
+#include "inifile/inifile.h"
+#include "inifile/stats.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#define INI_UNUSED(expr) (void)(expr)
+
+/// Nothing is recorded when instrumentation is disabled.
+TEST(Stats, Disabled)
+{
+    if constexpr (ini::stats::enabled)
+    {
+        GTEST_SKIP() << "Instrumentation is enabled.";
+    }
+
+    ini::stats::reset();
+    ini::File file;
+    ASSERT_TRUE(file.decode("[Section]\nkey = value\n"));
+    EXPECT_EQ(ini::stats::snapshot().decodes, 0);
+}
+
+/// Counters of a single decode are passed to the callback and accumulated.
+TEST(Stats, Parse)
+{
+    if constexpr (!ini::stats::enabled)
+    {
+        GTEST_SKIP() << "Instrumentation is disabled.";
+    }
+
+    std::vector<ini::stats::ParseStats> records;
+    ini::stats::reset();
+    ini::stats::set_callback([&records](ini::stats::ParseStats const& stats) { records.push_back(stats); });
+
+    ini::File file;
+    ASSERT_TRUE(file.decode("[A]\na = 1\nb = 2\n\n[B]\nc = a value long enough to live on the heap\n"));
+    EXPECT_FALSE(file.decode("[A]\nbad line\n"));
+    ini::stats::set_callback({});
+
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].lines, 6);
+    EXPECT_EQ(records[0].bytes, 65);
+    EXPECT_EQ(records[0].sections, 2);
+    EXPECT_EQ(records[0].keys, 3);
+    EXPECT_EQ(records[0].allocations, 6);
+    EXPECT_EQ(records[0].failures, 0);
+    EXPECT_EQ(records[1].failures, 1);
+
+    auto snapshot = ini::stats::snapshot();
+    EXPECT_EQ(snapshot.decodes, 2);
+    EXPECT_EQ(snapshot.parse.lines, 8);
+    EXPECT_EQ(snapshot.parse.failures, 1);
+}
+
+/// Failed conversions are counted per type.
+TEST(Stats, ConversionFailure)
+{
+    if constexpr (!ini::stats::enabled)
+    {
+        GTEST_SKIP() << "Instrumentation is disabled.";
+    }
+
+    ini::stats::reset();
+    ini::File file;
+    ASSERT_TRUE(file.decode("[Section]\nkey = value\n"));
+    EXPECT_THROW(INI_UNUSED(file["Section"]["key"].to<int>()), ini::DecodeError);
+    EXPECT_THROW(INI_UNUSED(file["Section"]["key"].to<int>()), ini::DecodeError);
+    EXPECT_THROW(INI_UNUSED(file["Section"]["key"].to<bool>()), ini::DecodeError);
+
+    auto failures = ini::stats::snapshot().conversion_failures;
+    EXPECT_EQ(failures[typeid(int)], 2);
+    EXPECT_EQ(failures[typeid(bool)], 1);
+}
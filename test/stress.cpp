@@ -0,0 +1,239 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <istream>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+
+namespace
+{
+    std::size_t current_bytes = 0;
+    std::size_t peak_bytes = 0;
+
+    /// Start measuring the peak heap usage from now.
+    void reset_peak()
+    {
+        peak_bytes = current_bytes;
+    }
+
+    /// Heap growth since reset_peak().
+    std::size_t peak_growth(std::size_t base)
+    {
+        return peak_bytes - base;
+    }
+
+    /// An endless input stream, made by repeating calls of a generator.
+    class GeneratorBuf: public std::streambuf
+    {
+      public:
+        explicit GeneratorBuf(std::function<std::string()> generate): generate_(std::move(generate)) {}
+
+      protected:
+        int_type underflow() override
+        {
+            chunk_.clear();
+            while (chunk_.size() < 4096)
+            {
+                chunk_ += generate_();
+            }
+            setg(chunk_.data(), chunk_.data(), chunk_.data() + chunk_.size());
+            return traits_type::to_int_type(chunk_.front());
+        }
+
+      private:
+        std::function<std::string()> generate_;
+        std::string chunk_;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Best time of a few runs, to reduce noise.
+    template<typename Function>
+    Clock::duration best_time(Function function)
+    {
+        auto best = Clock::duration::max();
+        for (int i = 0; i < 3; ++i)
+        {
+            auto begin = Clock::now();
+            function();
+            best = std::min(best, Clock::now() - begin);
+        }
+        return best;
+    }
+
+    /// Valid lines built to make every scan in the decoder as long as possible.
+    std::string adversarial_input(std::size_t lines)
+    {
+        std::string input = "[section]\n";
+        for (std::size_t i = 0; i < lines; ++i)
+        {
+            switch (i % 4)
+            {
+                case 0: input += "key" + std::to_string(i) + std::string(200, '=') + "\n"; break;
+                case 1: input += std::string(100, ' ') + "[" + std::string(100, '[') + "]\n"; break;
+                case 2: input += "key" + std::to_string(i) + " = " + std::string(100, 'v') + std::string(100, '#') + "\n"; break;
+                default: input += std::string(200, '\t') + ";\n"; break;
+            }
+        }
+        return input;
+    }
+} // anonymous namespace
+
+void* operator new(std::size_t size)
+{
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        current_bytes += ::malloc_usable_size(ptr);
+        peak_bytes = std::max(peak_bytes, current_bytes);
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC can not see that the replaced operator new pairs with std::free().
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        current_bytes -= ::malloc_usable_size(ptr);
+        std::free(ptr);
+    }
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    operator delete(ptr);
+}
+
+/// An endless line from a stream is rejected without buffering it.
+TEST(Stress, EndlessLine)
+{
+    GeneratorBuf buf([] { return std::string(1024, 'a'); });
+    std::istream input(&buf);
+
+    ini::File file;
+    file.set_limits(ini::Limits{.max_line_length = 1 << 20});
+
+    auto base = current_bytes;
+    reset_peak();
+    EXPECT_FALSE(file.decode(input));
+    EXPECT_LT(peak_growth(base), 4U << 20);
+    EXPECT_EQ(file.eroor(), "Limit exceeded at line 1: line length is larger than 1048576");
+}
+
+/// Streams are never read further than one byte past a limit.
+TEST(Stress, ReadNoFurther)
+{
+    ini::File file;
+    file.set_limits(ini::Limits{.max_line_length = 100});
+    std::istringstream long_line("[s]\nkey = " + std::string(1 << 20, 'v'));
+    EXPECT_FALSE(file.decode(long_line));
+    EXPECT_LE(long_line.tellg(), 4 + 101);
+
+    file.set_limits(ini::Limits{.max_total_bytes = 10});
+    std::istringstream blank_lines(std::string(1 << 20, '\n'));
+    EXPECT_FALSE(file.decode(blank_lines));
+    EXPECT_LE(blank_lines.tellg(), 11);
+}
+
+/// A long line in a string is rejected after scanning only the allowed length.
+TEST(Stress, LongLineInString)
+{
+    std::string text = "[section]\nkey = " + std::string(64 << 20, 'v');
+
+    ini::File file;
+    file.set_limits(ini::Limits{.max_line_length = 1024});
+
+    auto time = best_time([&] { EXPECT_FALSE(file.decode(text)); });
+    EXPECT_LT(time, std::chrono::milliseconds(10));
+    EXPECT_TRUE(file.empty());
+}
+
+/// A flood of tiny sections stops at the section limit.
+TEST(Stress, SectionFlood)
+{
+    std::size_t count = 0;
+    GeneratorBuf buf([&count] { return "[s" + std::to_string(count++) + "]\nk=v\n"; });
+    std::istream input(&buf);
+
+    ini::File file;
+    file.set_limits(ini::Limits{.max_sections = 1000});
+
+    std::vector<ini::Diagnostic> diagnostics;
+    EXPECT_FALSE(file.decode(input, diagnostics));
+    EXPECT_EQ(file.size(), 1000);
+    ASSERT_EQ(diagnostics.size(), 1);
+    EXPECT_EQ(diagnostics[0].kind, ini::Diagnostic::Kind::LimitExceeded);
+    EXPECT_EQ(diagnostics[0].line, 2002);
+}
+
+/// A flood of keys stops at the key limit.
+TEST(Stress, KeyFlood)
+{
+    std::size_t count = 0;
+    GeneratorBuf buf([&count] { return count++ == 0 ? std::string("[s]\n") : "k" + std::to_string(count) + "=v\n"; });
+    std::istream input(&buf);
+
+    ini::File file;
+    file.set_limits(ini::Limits{.max_keys = 5000});
+    EXPECT_FALSE(file.decode(input));
+    EXPECT_EQ(file["s"].size(), 5000);
+}
+
+/// An endless stream of blank lines stops at the total size limit.
+TEST(Stress, TotalBytes)
+{
+    GeneratorBuf buf([] { return std::string("\n"); });
+    std::istream input(&buf);
+
+    ini::File file;
+    file.set_limits(ini::Limits{.max_total_bytes = 1 << 20});
+
+    auto base = current_bytes;
+    reset_peak();
+    EXPECT_FALSE(file.decode(input));
+    EXPECT_LT(peak_growth(base), 1U << 20);
+
+    file.set_limits(ini::Limits{.max_total_bytes = 3});
+    EXPECT_FALSE(file.decode("[s]\n"));
+    EXPECT_TRUE(file.decode("[s]"));
+}
+
+/// Oversized keys and values are rejected.
+TEST(Stress, KeyValueSize)
+{
+    ini::File file;
+    file.set_limits(ini::Limits{.max_key_size = 4, .max_value_size = 4});
+    EXPECT_TRUE(file.decode("[s]\nkey = val\n"));
+    EXPECT_FALSE(file.decode("[s]\nkey12 = val\n"));
+    EXPECT_FALSE(file.decode("[s]\nkey = value\n"));
+}
+
+/// Decoding time grows linearly with adversarial input.
+TEST(Stress, LinearTime)
+{
+    auto small = adversarial_input(10000);
+    auto large = adversarial_input(80000);
+
+    auto small_time = best_time([&] { ini::File file; EXPECT_TRUE(file.decode(small)); });
+    auto large_time = best_time([&] { ini::File file; EXPECT_TRUE(file.decode(large)); });
+
+    // 8 times the input, with a wide margin for noise and O(k log k) map insertion.
+    EXPECT_LT(large_time, small_time * 20);
+    EXPECT_LT(large_time, std::chrono::seconds(2));
+}
@@ -0,0 +1,216 @@
+#include "inifile/inifile.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    std::string slurp(std::filesystem::path const& path)
+    {
+        std::ifstream stream(path);
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+        return buffer.str();
+    }
+
+    /// A fresh empty directory for each test.
+    std::filesystem::path make_directory(std::string const& name)
+    {
+        auto path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        return path;
+    }
+} // anonymous namespace
+
+/// Atomic write replaces the old content and leaves no temporary file.
+TEST(WriteAtomic, ReplaceExisting)
+{
+    auto directory = make_directory("inifile_test_write_atomic");
+    auto path = directory / "config.ini";
+
+    ini::File file;
+    file["Section"]["key"] = "old";
+    ASSERT_TRUE(file.write(path));
+
+    file["Section"]["key"] = "new";
+    ASSERT_TRUE(file.write(path, ini::WriteOptions{.atomic = true, .sync = true}));
+
+    EXPECT_EQ(slurp(path), file.encode());
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+/// A failed atomic write does not touch the target.
+TEST(WriteAtomic, MissingDirectory)
+{
+    ini::File file;
+    file["Section"]["key"] = "value";
+    EXPECT_FALSE(file.write("/nonexistent/inifile/config.ini", ini::WriteOptions{.atomic = true}));
+    EXPECT_FALSE(file.eroor().empty());
+}
+
+/// A parent that is not a directory is reported as an error.
+TEST(WriteAtomic, ParentIsFile)
+{
+    auto directory = make_directory("inifile_test_write_parent");
+    std::ofstream(directory / "file") << "content";
+
+    ini::File file;
+    file["Section"]["key"] = "value";
+    EXPECT_FALSE(file.write(directory / "file" / "config.ini", ini::WriteOptions{.atomic = true}));
+    EXPECT_FALSE(file.eroor().empty());
+
+    std::filesystem::remove_all(directory);
+}
+
+/// Atomic writes of one target from many threads never share a temporary file.
+TEST(WriteAtomic, Concurrent)
+{
+    auto directory = make_directory("inifile_test_write_concurrent");
+    auto path = directory / "config.ini";
+
+    ini::File first;
+    first["Section"]["key"] = std::string(4096, 'a');
+    ini::File second;
+    second["Section"]["key"] = std::string(4096, 'b');
+
+    std::atomic<int> failures = 0;
+    auto run = [&](ini::File const& file) {
+        for (int i = 0; i < 50; ++i)
+        {
+            // Each File has its own error, so the threads do not share it.
+            if (!file.write(path, ini::WriteOptions{.atomic = true}))
+            {
+                ++failures;
+            }
+        }
+    };
+    std::thread thread(run, std::cref(first));
+    run(second);
+    thread.join();
+
+    EXPECT_EQ(failures, 0);
+    auto content = slurp(path);
+    EXPECT_TRUE(content == first.encode() || content == second.encode());
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+/// Atomic write keeps the permissions of the replaced file.
+TEST(WriteAtomic, KeepMode)
+{
+    auto directory = make_directory("inifile_test_write_mode");
+    auto path = directory / "config.ini";
+    std::ofstream(path) << "";
+    std::filesystem::permissions(path, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+
+    ini::File file;
+    file["Section"]["key"] = "secret";
+    ASSERT_TRUE(file.write(path, ini::WriteOptions{.atomic = true})) << file.eroor();
+
+    EXPECT_EQ(std::filesystem::status(path).permissions(), std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+    EXPECT_EQ(slurp(path), file.encode());
+
+    std::filesystem::remove_all(directory);
+}
+
+/// Atomic write through a symlink replaces the file it points to.
+TEST(WriteAtomic, Symlink)
+{
+    auto directory = make_directory("inifile_test_write_symlink");
+    std::filesystem::create_directories(directory / "real");
+    auto real = directory / "real" / "config.ini";
+    auto link = directory / "config.ini";
+    std::ofstream(real) << "";
+    std::filesystem::create_symlink(std::filesystem::path("real") / "config.ini", link);
+
+    ini::File file;
+    file["Section"]["key"] = "value";
+    ASSERT_TRUE(file.write(link, ini::WriteOptions{.atomic = true})) << file.eroor();
+    EXPECT_TRUE(std::filesystem::is_symlink(link));
+    EXPECT_EQ(slurp(real), file.encode());
+
+    ini::BatchWriter writer(false);
+    file["Section"]["key"] = "batch";
+    writer.add(file, link);
+    ASSERT_TRUE(writer.commit()) << writer.error();
+    EXPECT_TRUE(std::filesystem::is_symlink(link));
+    EXPECT_EQ(slurp(real), file.encode());
+
+    std::filesystem::remove_all(directory);
+}
+
+/// Commit many files at once.
+TEST(BatchWriter, Commit)
+{
+    auto directory = make_directory("inifile_test_write_batch");
+
+    ini::BatchWriter writer;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 8; ++i)
+    {
+        ini::File file;
+        file["Section"]["index"] = std::to_string(i);
+        writer.add(file, directory / (std::to_string(i) + ".ini"));
+        expected.push_back(file.encode());
+    }
+    ASSERT_TRUE(writer.commit());
+
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_EQ(slurp(directory / (std::to_string(i) + ".ini")), expected[i]);
+    }
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 8);
+
+    std::filesystem::remove_all(directory);
+}
+
+/// No target is created when one of the files can not be written.
+TEST(BatchWriter, FailureLeavesNoFile)
+{
+    auto directory = make_directory("inifile_test_write_batch_failure");
+
+    ini::File file;
+    file["Section"]["key"] = "value";
+
+    ini::BatchWriter writer(false);
+    writer.add(file, directory / "good.ini");
+    writer.add(file, directory / "missing" / "bad.ini");
+    EXPECT_FALSE(writer.commit());
+    EXPECT_FALSE(writer.error().empty());
+
+    EXPECT_TRUE(std::filesystem::is_empty(directory));
+
+    std::filesystem::remove_all(directory);
+}
+
+/// A target added twice is written once, with the last content.
+TEST(BatchWriter, RepeatedPath)
+{
+    auto directory = make_directory("inifile_test_write_batch_repeated");
+
+    ini::File first;
+    first["Section"]["key"] = "first";
+    ini::File second;
+    second["Section"]["key"] = "second";
+
+    ini::BatchWriter writer(false);
+    writer.add(first, directory / "config.ini");
+    writer.add(second, directory / "." / "config.ini");
+    ASSERT_TRUE(writer.commit()) << writer.error();
+
+    EXPECT_EQ(slurp(directory / "config.ini"), second.encode());
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+
+    std::filesystem::remove_all(directory);
+}
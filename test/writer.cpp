@@ -0,0 +1,78 @@
+#include "inifile/inifile.h"
+#include "inifile/writer.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std::string_literals;
+
+/// Output is identical to File::encode() for sorted input.
+TEST(Writer, SameAsEncode)
+{
+    ini::File file;
+    file["A"]["key"] = "value";
+    file["A"]["other"] = "value with = sign";
+    file["B"]["number"] = "42";
+
+    std::stringstream stream;
+    {
+        ini::Writer writer(stream);
+        writer.section("A").kv("key", "value").kv("other", "value with = sign"s);
+        writer.section("B").kv("number", 42);
+    }
+    EXPECT_EQ(stream.str(), file.encode());
+}
+
+/// Numbers and booleans are decoded back to the same values.
+TEST(Writer, RoundTrip)
+{
+    std::stringstream stream;
+    {
+        ini::Writer writer(stream);
+        writer.section("Section")
+              .kv("int", -17)
+              .kv("unsigned", 4000000000U)
+              .kv("float", 0.1F)
+              .kv("double", 1e-300)
+              .kv("bool", true);
+    }
+
+    ini::File file;
+    ASSERT_TRUE(file.decode(stream.str()));
+    EXPECT_EQ(file["Section"]["int"].to<int>(), -17);
+    EXPECT_EQ(file["Section"]["unsigned"].to<unsigned>(), 4000000000U);
+    EXPECT_EQ(file["Section"]["float"].to<float>(), 0.1F);
+    EXPECT_EQ(file["Section"]["double"].to<double>(), 1e-300);
+    EXPECT_EQ(file["Section"]["bool"].to<bool>(), true);
+}
+
+/// Output larger than the buffer is flushed in order.
+TEST(Writer, LargeOutput)
+{
+    ini::File file;
+    std::stringstream stream;
+    {
+        ini::Writer writer(stream);
+        writer.section("Section");
+        std::string long_value(10000, 'x');
+        for (int i = 0; i < 100; ++i)
+        {
+            auto key = "key" + std::to_string(1000 + i);
+            writer.kv(key, long_value);
+            file["Section"][key] = long_value;
+        }
+    }
+    EXPECT_EQ(stream.str(), file.encode());
+}
+
+/// Nothing is written without any section.
+TEST(Writer, Empty)
+{
+    std::stringstream stream;
+    {
+        ini::Writer writer(stream);
+    }
+    EXPECT_EQ(stream.str(), "");
+}
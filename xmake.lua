@@ -2,21 +2,33 @@ set_project("inifile")
 set_version("0.0.1")
 
 add_rules("mode.debug", "mode.release")
+set_languages("c++20")
+
+option("stats", function()
+    set_default(false)
+    set_showmenu(true)
+    set_description("Enable parse instrumentation and statistics.")
+end)
 
 add_requires("gtest", {configs = {main = true}})
 add_requires("fmt")
 
-target("stralgo", function()
-    set_kind("object")
-    add_files("src/stralgo.cpp")
-end)
-
 target("inifile", function()
     set_kind("static")
-    add_files("src/inifile.cpp")
+    add_files("src/inifile.cpp", "src/fileio.cpp", "src/stats.cpp", "src/writer.cpp", "src/diff.cpp", "src/fingerprint.cpp", "src/interpolate.cpp", "src/query.cpp", "src/memory.cpp")
+    if has_config("stats") then
+        add_defines("INI_ENABLE_STATS", {public = true})
+    end
     add_includedirs("include", {public = true})
     add_packages("fmt", {public = true})
-    add_deps("stralgo")
+    -- File I/O falls back to standard C++ on Windows, where shared memory is not available.
+    if not is_plat("windows") then
+        add_files("src/shared.cpp")
+        add_syslinks("pthread", {public = true})
+    end
+    if is_plat("linux") then
+        add_syslinks("rt", {public = true})
+    end
 end)
 
 -- A simple interactive demo.
@@ -35,7 +47,7 @@ target("test.stralgo", function()
     add_packages("gtest")
 
     add_files("src/stralgo.test.cpp")
-    add_deps("stralgo")
+    add_includedirs("include")
 end)
 
 target("test.basic_decode_encode", function()
@@ -59,3 +71,171 @@ target("test.decode", function()
     add_files("test/decode.cpp")
     add_deps("inifile")
 end)
+
+target("test.async", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/async.cpp")
+    add_deps("inifile")
+end)
+
+target("test.write", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/write.cpp")
+    add_deps("inifile")
+end)
+
+target("test.diagnostics", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/diagnostics.cpp")
+    add_deps("inifile")
+end)
+
+target("test.stats", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/stats.cpp")
+    add_deps("inifile")
+end)
+
+target("test.allocation", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/allocation.cpp")
+    add_deps("inifile")
+end)
+
+target("test.writer", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/writer.cpp")
+    add_deps("inifile")
+end)
+
+target("test.diff", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/diff.cpp")
+    add_deps("inifile")
+end)
+
+target("test.fingerprint", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/fingerprint.cpp")
+    add_deps("inifile")
+end)
+
+target("test.interpolate", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/interpolate.cpp")
+    add_deps("inifile")
+end)
+
+target("test.query", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/query.cpp")
+    add_deps("inifile")
+end)
+
+target("test.static", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/static.cpp")
+    add_deps("inifile")
+end)
+
+target("test.shared", function()
+    set_kind("binary")
+    set_default(false)
+    if is_plat("windows") then
+        set_enabled(false)
+    end
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/shared.cpp")
+    add_deps("inifile")
+end)
+
+target("test.stress", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/stress.cpp")
+    add_deps("inifile")
+end)
+
+target("test.parallel", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/parallel.cpp")
+    add_deps("inifile")
+end)
+
+target("test.memory", function()
+    set_kind("binary")
+    set_default(false)
+
+    set_group("test.system")
+    add_packages("gtest")
+
+    add_files("test/memory.cpp")
+    add_deps("inifile")
+end)